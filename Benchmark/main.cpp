@@ -0,0 +1,1073 @@
+#include <QtTest>
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "qunorderedtree.h"
+#include "qorderedtree.h"
+#include "qsmallchildmap.h"
+#include "qflatmap.h"
+#include "qflathash.h"
+#include "qfrozentree.h"
+#include "qgenerictreecbor.h"
+
+class QGenericTreeBenchmark : public QObject
+{
+	Q_OBJECT
+
+public:
+	enum ContainerType {
+		Ordered,
+		Unordered,
+		SmallOrdered,
+		SmallUnordered,
+		FlatOrdered,
+		FlatUnordered
+	};
+	Q_ENUM(ContainerType)
+
+private Q_SLOTS:
+	void build_data();
+	void build();
+	void buildPaths_data();
+	void buildPaths();
+	void fromSorted_data();
+	void fromSorted();
+	void dataStream_data();
+	void dataStream();
+	void cbor_data();
+	void cbor();
+	void json_data();
+	void json();
+	void find_data();
+	void find();
+	void frozenFind_data();
+	void frozenFind();
+	void subscript_data();
+	void subscript();
+	void iterate_data();
+	void iterate();
+	void reverseIterate_data();
+	void reverseIterate();
+	void bfsIterate_data();
+	void bfsIterate();
+	void postorderIterate_data();
+	void postorderIterate();
+	void foldUp_data();
+	void foldUp();
+	void sparseIterate_data();
+	void sparseIterate();
+	void sparseValueIterate_data();
+	void sparseValueIterate();
+	void parallelReduce_data();
+	void parallelReduce();
+	void clone_data();
+	void clone();
+	void parallelClone_data();
+	void parallelClone();
+	void countElements_data();
+	void countElements();
+	void subKey_data();
+	void subKey();
+	void key_data();
+	void key();
+	void teardown_data();
+	void teardown();
+
+	void wideInsert_data();
+	void wideInsert();
+	void wideFind_data();
+	void wideFind();
+
+	void deepFind_data();
+	void deepFind();
+	void deepFindStepwise_data();
+	void deepFindStepwise();
+
+	void lockedInsert_data();
+	void lockedInsert();
+
+private:
+	template <typename TTree>
+	struct TreeType {
+		using Tree = TTree;
+	};
+
+	// width and depth of the full trees the tree benchmarks run on
+	static const QList<QPair<int, int>> Shapes;
+	// children of the single node the wide benchmarks run on
+	static const QList<int> Widths;
+	// length of the paths the deep benchmarks look up
+	static const QList<int> Depths;
+
+	static const char *containerName(ContainerType container);
+	static int nodeCount(int width, int depth);
+
+	void treeData(const QList<ContainerType> &containers);
+	void wideData();
+	void deepData();
+	template <typename TFunctor>
+	void withTree(TFunctor &&functor);
+	template <typename TNode>
+	void fill(TNode node, int width, int depth);
+	template <typename TTree>
+	QList<QList<int>> sampleKeys(const TTree &tree);
+	template <typename TTree>
+	int fillSparse(TTree &tree, int width, int depth);
+	QVector<QPair<QVector<int>, int>> sortedEntries(int width, int depth);
+	template <typename TTree>
+	QVector<int> fillDeep(TTree &tree, int depth);
+};
+
+const QList<QPair<int, int>> QGenericTreeBenchmark::Shapes {
+	{2, 12},
+	{4, 6},
+	{10, 4},
+	{100, 2},
+	{10000, 1}
+};
+
+const QList<int> QGenericTreeBenchmark::Widths {16, 256, 4096, 65536};
+
+const QList<int> QGenericTreeBenchmark::Depths {8, 64};
+
+void QGenericTreeBenchmark::build_data()
+{
+	treeData({Ordered, Unordered, SmallOrdered, SmallUnordered, FlatOrdered, FlatUnordered});
+}
+
+void QGenericTreeBenchmark::build()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		// keep the trees alive until the benchmark is done, so their teardown is not measured
+		std::vector<Tree> trees;
+		QBENCHMARK {
+			trees.emplace_back();
+			fill(trees.back().rootNode(), width, depth);
+		}
+		QCOMPARE(trees.back().countElements(), nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::buildPaths_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::buildPaths()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		// the baseline for fromSorted: every entry descends from the root again
+		const auto entries = sortedEntries(width, depth);
+		std::vector<Tree> trees;
+		QBENCHMARK {
+			trees.emplace_back();
+			auto &tree = trees.back();
+			for (const auto &entry : entries)
+				tree[QGenericTreeKeySpan<int>{entry.first}] = entry.second;
+		}
+		QCOMPARE(trees.back().countElements(), nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::fromSorted_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::fromSorted()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		const auto entries = sortedEntries(width, depth);
+		std::vector<Tree> trees;
+		QBENCHMARK {
+			trees.push_back(Tree::fromSorted(entries.cbegin(), entries.cend()));
+		}
+		QCOMPARE(trees.back().countElements(), nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::dataStream_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::dataStream()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		const auto entries = sortedEntries(width, depth);
+		const auto tree = Tree::fromSorted(entries.cbegin(), entries.cend());
+		QByteArray data;
+		Tree loaded;
+		QBENCHMARK {
+			data.clear();
+			QDataStream out{&data, QIODevice::WriteOnly};
+			out << tree;
+			QDataStream in{data};
+			in >> loaded;
+		}
+		QCOMPARE(loaded.countElements(), nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::cbor_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::cbor()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		const auto entries = sortedEntries(width, depth);
+		const auto tree = Tree::fromSorted(entries.cbegin(), entries.cend());
+		QByteArray data;
+		Tree loaded;
+		QBENCHMARK {
+			data.clear();
+			QCborStreamWriter writer{&data};
+			QGenericTreeCbor::writeCbor(writer, tree);
+			QCborStreamReader reader{data};
+			QVERIFY(QGenericTreeCbor::readCbor(reader, loaded));
+		}
+		QCOMPARE(loaded.countElements(), nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::json_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::json()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		const auto entries = sortedEntries(width, depth);
+		const auto tree = Tree::fromSorted(entries.cbegin(), entries.cend());
+		QBuffer buffer;
+		Tree loaded;
+		QBENCHMARK {
+			buffer.close();
+			buffer.setData(QByteArray{});
+			buffer.open(QIODevice::ReadWrite);
+			QVERIFY(QGenericTreeCbor::writeJson(&buffer, tree));
+			buffer.seek(0);
+			QVERIFY(QGenericTreeCbor::readJson(&buffer, loaded));
+		}
+		QCOMPARE(loaded.countElements(), nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::find_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::find()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+		const auto keys = sampleKeys(tree);
+
+		auto hits = 0;
+		QBENCHMARK {
+			hits = 0;
+			for (const auto &key : keys) {
+				if (qAsConst(tree).find(key))
+					++hits;
+			}
+		}
+		QCOMPARE(hits, keys.size());
+	});
+}
+
+void QGenericTreeBenchmark::frozenFind_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::frozenFind()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+		const auto keys = sampleKeys(tree);
+		QTemporaryDir dir;
+		const auto fileName = dir.filePath(QStringLiteral("tree.frozen"));
+		QVERIFY(QFrozenTree<int, int>::freeze(tree, fileName));
+		const QFrozenTree<int, int> frozen{fileName};
+		QVERIFY(frozen.isOpen());
+
+		auto hits = 0;
+		QBENCHMARK {
+			hits = 0;
+			for (const auto &key : keys) {
+				if (frozen.find(key))
+					++hits;
+			}
+		}
+		QCOMPARE(hits, keys.size());
+	});
+}
+
+void QGenericTreeBenchmark::subscript_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::subscript()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+		const auto keys = sampleKeys(tree);
+
+		auto sum = 0;
+		QBENCHMARK {
+			sum = 0;
+			for (const auto &key : keys)
+				sum += *tree[key];
+		}
+		QVERIFY(sum > 0);
+		QCOMPARE(tree.countElements(), nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::iterate_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::iterate()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+
+		auto cnt = 0;
+		QBENCHMARK {
+			cnt = 0;
+			for (const auto &value : qAsConst(tree))
+				cnt += value >= 0 ? 1 : 0;
+		}
+		QCOMPARE(cnt, nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::reverseIterate_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::reverseIterate()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+
+		auto cnt = 0;
+		QBENCHMARK {
+			cnt = 0;
+			for (auto it = qAsConst(tree).end(), begin = qAsConst(tree).begin(); it != begin;) {
+				--it;
+				cnt += *it >= 0 ? 1 : 0;
+			}
+		}
+		QCOMPARE(cnt, nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::bfsIterate_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::bfsIterate()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+
+		auto cnt = 0;
+		QBENCHMARK {
+			cnt = 0;
+			for (auto it = qAsConst(tree).bfs_begin(), end = qAsConst(tree).bfs_end(); it != end; ++it)
+				cnt += *it >= 0 ? 1 : 0;
+		}
+		QCOMPARE(cnt, nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::postorderIterate_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::postorderIterate()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+
+		auto cnt = 0;
+		QBENCHMARK {
+			cnt = 0;
+			for (auto it = qAsConst(tree).postorder_begin(), end = qAsConst(tree).postorder_end(); it != end; ++it)
+				cnt += *it >= 0 ? 1 : 0;
+		}
+		QCOMPARE(cnt, nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::foldUp_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::foldUp()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+
+		// the number of nodes per subtree, bottom up
+		auto cnt = 0;
+		QBENCHMARK {
+			cnt = tree.template foldUp<int>([](const auto &, const auto &childResults) {
+				return std::accumulate(childResults.begin(), childResults.end(), 1);
+			});
+		}
+		QCOMPARE(cnt, nodeCount(width, depth) + 1);
+	});
+}
+
+void QGenericTreeBenchmark::sparseIterate_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::sparseIterate()
+{
+	// the baseline for sparseValueIterate: every node is tested for a value
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		const auto values = fillSparse(tree, width, depth);
+
+		auto cnt = 0;
+		QBENCHMARK {
+			cnt = 0;
+			for (auto it = qAsConst(tree).begin(), end = qAsConst(tree).end(); it != end; ++it) {
+				if (it)
+					++cnt;
+			}
+		}
+		QCOMPARE(cnt, values);
+	});
+}
+
+void QGenericTreeBenchmark::sparseValueIterate_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::sparseValueIterate()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		const auto values = fillSparse(tree, width, depth);
+
+		auto cnt = 0;
+		QBENCHMARK {
+			cnt = 0;
+			for (auto it = qAsConst(tree).valueBegin(), end = qAsConst(tree).valueEnd(); it != end; ++it)
+				cnt += *it >= 0 ? 1 : 0;
+		}
+		QCOMPARE(cnt, values);
+	});
+}
+
+void QGenericTreeBenchmark::parallelReduce_data()
+{
+	treeData({Ordered, Unordered, FlatOrdered});
+}
+
+void QGenericTreeBenchmark::parallelReduce()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+
+		// compare with iterate, which walks the same tree on a single thread
+		auto cnt = 0;
+		QBENCHMARK {
+			cnt = qAsConst(tree).parallelReduce([](int value) {
+				return value >= 0 ? 1 : 0;
+			}, [](int &result, int value) {
+				result += value;
+			});
+		}
+		QCOMPARE(cnt, nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::clone_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::clone()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+
+		// keep the clones alive until the benchmark is done, so their teardown is not measured
+		std::vector<Tree> clones;
+		QBENCHMARK {
+			clones.push_back(tree.clone());
+		}
+		QCOMPARE(clones.back().countElements(), nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::parallelClone_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::parallelClone()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+
+		std::vector<Tree> clones;
+		QBENCHMARK {
+			clones.push_back(tree.clone(QGenericTreeParallel));
+		}
+		QCOMPARE(clones.back().countElements(), nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::countElements_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::countElements()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+
+		auto cnt = 0;
+		QBENCHMARK {
+			cnt = tree.countElements();
+		}
+		QCOMPARE(cnt, nodeCount(width, depth));
+	});
+}
+
+void QGenericTreeBenchmark::subKey_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::subKey()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+		QList<typename Tree::ConstNode> nodes;
+		for (auto it = qAsConst(tree).begin(), end = qAsConst(tree).end(); it != end; ++it)
+			nodes.append(it.node());
+
+		auto sum = 0;
+		QBENCHMARK {
+			sum = 0;
+			for (const auto &node : qAsConst(nodes))
+				sum += node.subKey();
+		}
+		QVERIFY(sum > 0);
+	});
+}
+
+void QGenericTreeBenchmark::key_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::key()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+		QList<typename Tree::ConstNode> nodes;
+		for (auto it = qAsConst(tree).begin(), end = qAsConst(tree).end(); it != end; ++it)
+			nodes.append(it.node());
+
+		auto sum = 0;
+		QBENCHMARK {
+			sum = 0;
+			for (const auto &node : qAsConst(nodes))
+				sum += node.key().size();
+		}
+		QVERIFY(sum >= nodes.size());
+	});
+}
+
+void QGenericTreeBenchmark::teardown_data()
+{
+	build_data();
+}
+
+void QGenericTreeBenchmark::teardown()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+		QFETCH(int, depth);
+
+		Tree tree;
+		fill(tree.rootNode(), width, depth);
+
+		// a tree can only be torn down once, so this can only be measured once as well
+		QBENCHMARK_ONCE {
+			tree.clear();
+		}
+		QCOMPARE(tree.countElements(), 0);
+	});
+}
+
+void QGenericTreeBenchmark::wideInsert_data()
+{
+	wideData();
+}
+
+void QGenericTreeBenchmark::wideInsert()
+{
+	withTree([](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+
+		QBENCHMARK {
+			Tree tree;
+			auto root = tree.rootNode();
+			for (auto i = 0; i < width; ++i)
+				root.emplaceChild(i * 7919) = i;
+		}
+	});
+}
+
+void QGenericTreeBenchmark::wideFind_data()
+{
+	wideData();
+}
+
+void QGenericTreeBenchmark::wideFind()
+{
+	withTree([](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, width);
+
+		Tree tree;
+		auto root = tree.rootNode();
+		for (auto i = 0; i < width; ++i)
+			root.emplaceChild(i * 7919) = i;
+
+		auto hits = 0;
+		QBENCHMARK {
+			// every second lookup misses
+			hits = 0;
+			for (auto i = 0; i < width * 2; ++i) {
+				if (qAsConst(root).child(i % 2 == 0 ? i / 2 * 7919 : -i))
+					++hits;
+			}
+		}
+		QCOMPARE(hits, width);
+	});
+}
+
+void QGenericTreeBenchmark::deepFind_data()
+{
+	deepData();
+}
+
+void QGenericTreeBenchmark::deepFind()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, depth);
+
+		Tree tree;
+		const auto path = fillDeep(tree, depth);
+
+		auto hits = 0;
+		QBENCHMARK {
+			hits = 0;
+			for (auto i = 0; i < 1000; ++i) {
+				if (qAsConst(tree).find(path))
+					++hits;
+			}
+		}
+		QCOMPARE(hits, 1000);
+	});
+}
+
+void QGenericTreeBenchmark::deepFindStepwise_data()
+{
+	deepData();
+}
+
+void QGenericTreeBenchmark::deepFindStepwise()
+{
+	withTree([this](auto type) {
+		using Tree = typename decltype(type)::Tree;
+		QFETCH(int, depth);
+
+		Tree tree;
+		const auto path = fillDeep(tree, depth);
+
+		// the baseline: descending node by node copies a node handle per level
+		auto hits = 0;
+		QBENCHMARK {
+			hits = 0;
+			for (auto i = 0; i < 1000; ++i) {
+				auto node = qAsConst(tree).rootNode();
+				for (const auto key : path) {
+					node = node.child(key);
+					if (!node)
+						break;
+				}
+				if (node)
+					++hits;
+			}
+		}
+		QCOMPARE(hits, 1000);
+	});
+}
+
+void QGenericTreeBenchmark::lockedInsert_data()
+{
+	QTest::addColumn<bool>("nodeLocks");
+	QTest::addColumn<int>("threads");
+
+	for (const auto threads : {1, 2, 4, 8, 16, 32}) {
+		QTest::addRow("one mutex, %d threads", threads) << false << threads;
+		QTest::addRow("node locks, %d threads", threads) << true << threads;
+	}
+}
+
+void QGenericTreeBenchmark::lockedInsert()
+{
+	using LockedTree = QUnorderedTree<int, int, QGenericTreeHeapAllocator, QGenericTreeSharedPointerPolicy, QGenericTreeNodeLockPolicy>;
+	QFETCH(bool, nodeLocks);
+	QFETCH(int, threads);
+
+	// every thread fills a subtree of its own, the same amount of work for any number of threads
+	constexpr auto NodeCount = 1 << 16;
+	const auto run = [threads](auto &tree, auto &&insert) {
+		std::vector<std::thread> workers;
+		for (auto t = 0; t < threads; ++t) {
+			workers.emplace_back([&, t]() {
+				for (auto i = 0; i < NodeCount / threads; ++i) {
+					const int path[] = {t, i / 64, i % 64};
+					insert(tree, QGenericTreeKeySpan<int>{path, 3}, i);
+				}
+			});
+		}
+		for (auto &worker : workers)
+			worker.join();
+	};
+
+	if (nodeLocks) {
+		std::vector<LockedTree> trees;
+		QBENCHMARK {
+			trees.emplace_back();
+			run(trees.back(), [](LockedTree &tree, QGenericTreeKeySpan<int> path, int value) {
+				tree[path] = value;
+			});
+		}
+		QCOMPARE(trees.back().countElements(true), NodeCount / threads * threads);
+	} else {
+		std::vector<QUnorderedTree<int, int>> trees;
+		QMutex mutex;
+		QBENCHMARK {
+			trees.emplace_back();
+			run(trees.back(), [&mutex](QUnorderedTree<int, int> &tree, QGenericTreeKeySpan<int> path, int value) {
+				QMutexLocker locker{&mutex};
+				tree[path] = value;
+			});
+		}
+		QCOMPARE(trees.back().countElements(true), NodeCount / threads * threads);
+	}
+}
+
+const char *QGenericTreeBenchmark::containerName(ContainerType container)
+{
+	switch (container) {
+	case Ordered:
+		return "QOrderedTree";
+	case Unordered:
+		return "QUnorderedTree";
+	case SmallOrdered:
+		return "QSmallOrderedTree";
+	case SmallUnordered:
+		return "QSmallUnorderedTree";
+	case FlatOrdered:
+		return "QFlatOrderedTree";
+	case FlatUnordered:
+		return "QFlatUnorderedTree";
+	}
+	Q_UNREACHABLE();
+	return nullptr;
+}
+
+int QGenericTreeBenchmark::nodeCount(int width, int depth)
+{
+	auto count = 0;
+	auto levelCount = 1;
+	for (auto i = 0; i < depth; ++i) {
+		levelCount *= width;
+		count += levelCount;
+	}
+	return count;
+}
+
+void QGenericTreeBenchmark::treeData(const QList<ContainerType> &containers)
+{
+	QTest::addColumn<ContainerType>("container");
+	QTest::addColumn<int>("width");
+	QTest::addColumn<int>("depth");
+
+	for (const auto container : containers) {
+		for (const auto &shape : Shapes) {
+			QTest::addRow("%s, %d nodes (width %d, depth %d)",
+						  containerName(container),
+						  nodeCount(shape.first, shape.second),
+						  shape.first,
+						  shape.second)
+				<< container << shape.first << shape.second;
+		}
+	}
+}
+
+void QGenericTreeBenchmark::wideData()
+{
+	QTest::addColumn<ContainerType>("container");
+	QTest::addColumn<int>("width");
+
+	for (const auto container : {Unordered, FlatUnordered, Ordered, FlatOrdered}) {
+		for (const auto width : Widths)
+			QTest::addRow("%s, %d children", containerName(container), width) << container << width;
+	}
+}
+
+void QGenericTreeBenchmark::deepData()
+{
+	QTest::addColumn<ContainerType>("container");
+	QTest::addColumn<int>("depth");
+
+	for (const auto container : {Ordered, Unordered, FlatOrdered, FlatUnordered}) {
+		for (const auto depth : Depths)
+			QTest::addRow("%s, depth %d", containerName(container), depth) << container << depth;
+	}
+}
+
+template <typename TFunctor>
+void QGenericTreeBenchmark::withTree(TFunctor &&functor)
+{
+	QFETCH(ContainerType, container);
+	switch (container) {
+	case Ordered:
+		functor(TreeType<QOrderedTree<int, int>>{});
+		break;
+	case Unordered:
+		functor(TreeType<QUnorderedTree<int, int>>{});
+		break;
+	case SmallOrdered:
+		functor(TreeType<QSmallOrderedTree<int, int>>{});
+		break;
+	case SmallUnordered:
+		functor(TreeType<QSmallUnorderedTree<int, int>>{});
+		break;
+	case FlatOrdered:
+		functor(TreeType<QFlatOrderedTree<int, int>>{});
+		break;
+	case FlatUnordered:
+		functor(TreeType<QFlatUnorderedTree<int, int>>{});
+		break;
+	}
+}
+
+template <typename TNode>
+void QGenericTreeBenchmark::fill(TNode node, int width, int depth)
+{
+	if (depth == 0)
+		return;
+	for (auto i = 0; i < width; ++i) {
+		auto child = node.emplaceChild(i);
+		child = i + 1;
+		fill(child, width, depth - 1);
+	}
+}
+
+template <typename TTree>
+QList<QList<int>> QGenericTreeBenchmark::sampleKeys(const TTree &tree)
+{
+	// up to 1000 keys, spread evenly across the whole tree
+	const auto count = tree.countElements();
+	const auto step = qMax(1, count / 1000);
+	QList<QList<int>> keys;
+	auto index = 0;
+	for (auto it = tree.begin(), end = tree.end(); it != end; ++it, ++index) {
+		if (index % step == 0)
+			keys.append(it.key());
+	}
+	return keys;
+}
+
+template <typename TTree>
+int QGenericTreeBenchmark::fillSparse(TTree &tree, int width, int depth)
+{
+	// a full tree where only every 100th node in preorder keeps its value
+	fill(tree.rootNode(), width, depth);
+	auto index = 0;
+	auto values = 0;
+	for (auto it = tree.begin(), end = tree.end(); it != end; ++it, ++index) {
+		if (index % 100 == 0)
+			++values;
+		else
+			it.node().clearValue();
+	}
+	return values;
+}
+
+QVector<QPair<QVector<int>, int>> QGenericTreeBenchmark::sortedEntries(int width, int depth)
+{
+	// the paths of the same full tree fill() creates, in preorder and therefore sorted
+	QVector<QPair<QVector<int>, int>> entries;
+	entries.reserve(nodeCount(width, depth));
+	QVector<int> path;
+	const auto addLevel = [&](const auto &self) -> void {
+		if (path.size() == depth)
+			return;
+		for (auto i = 0; i < width; ++i) {
+			path.append(i);
+			entries.append({path, i + 1});
+			self(self);
+			path.removeLast();
+		}
+	};
+	addLevel(addLevel);
+	return entries;
+}
+
+template <typename TTree>
+QVector<int> QGenericTreeBenchmark::fillDeep(TTree &tree, int depth)
+{
+	// every level has a few siblings, the path always continues at the last one
+	QVector<int> path;
+	path.reserve(depth);
+	auto node = tree.rootNode();
+	for (auto level = 0; level < depth; ++level) {
+		for (auto i = 0; i < 8; ++i)
+			node.emplaceChild(i) = i;
+		node = node.child(7);
+		path.append(7);
+	}
+	return path;
+}
+
+QTEST_MAIN(QGenericTreeBenchmark)
+
+#include "main.moc"
@@ -1,7 +1,21 @@
 #include <QtTest>
 
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <vector>
+
 #include "qunorderedtree.h"
 #include "qorderedtree.h"
+#include "qgenerictreearena.h"
+#include "qgenerictreeintrusive.h"
+#include "qsmallchildmap.h"
+#include "qflatmap.h"
+#include "qflathash.h"
+#include "qpathtree.h"
+#include "qconcurrenttree.h"
+#include "qfrozentree.h"
+#include "qgenerictreecbor.h"
 
 #define L2(a, b) {a, b}
 #define L3(a, b, c) {a, b, c}
@@ -16,6 +30,26 @@ private Q_SLOTS:
 	void testNodeCildTrees();
 	void testTreeBasics();
 	void testIterators();
+	void testArenaAllocator();
+	void testIntrusivePointers();
+	void testSmallChildMap();
+	void testFlatMap();
+	void testFlatHash();
+	void testSubtreeCounters();
+	void testKeyRanges();
+	void testHeterogeneousLookup();
+	void testPathTree();
+	void testFromSorted();
+	void testParallelAlgorithms();
+	void testParallelClone();
+	void testConcurrentTree();
+	void testNodeLocks();
+	void testDataStream();
+	void testFrozenTree();
+	void testCborJson();
+	void testBfsIterators();
+	void testPostorder();
+	void testFilteredIterators();
 
 private:
 	using TestTree = QUnorderedTree<int, int>;
@@ -159,8 +193,23 @@ void QGenericTreeTest::testNodeChildren()
 	QCOMPARE(testNode[7].depth(), 1);
 	QCOMPARE(testNode[7].subKey(), 7);
 	QCOMPARE(testNode[7].key(), QList<int>{7});
+	auto clearedChild = testNode[7];
 	testNode.clearChildren();
 	QCOMPARE(testNode.hasChildren(), false);
+	QVERIFY(!clearedChild.parent());
+	QCOMPARE(clearedChild.subKey(), 0);
+
+	// replace a child
+	auto replacedChild = testNode.emplaceChild(5);
+	auto replacingChild = testNode.emplaceChild(5);
+	QCOMPARE(testNode.childCount(), 1);
+	QCOMPARE(testNode[5], replacingChild);
+	QVERIFY(!replacedChild.parent());
+	QCOMPARE(replacedChild.subKey(), 0);
+	replacedChild.detach();
+	QCOMPARE(testNode[5], replacingChild);
+	QCOMPARE(replacingChild.subKey(), 5);
+	testNode.clearChildren();
 
 	TestTree::Node swapNode;
 	testNode = 1;
@@ -237,12 +286,19 @@ void QGenericTreeTest::testNodeCildTrees()
 	QCOMPARE(cloned.containsChild(6), true);
 	QVERIFY(cloned[5] != node5);
 	QVERIFY(cloned[6] != node6);
+	QCOMPARE(cloned.subKey(), 0);
+	QCOMPARE(cloned[5].parent(), cloned);
+	QCOMPARE(cloned[6].key(), QList<int>{6});
 
 	// detach 3
+	QCOMPARE(node5.key(), QList<int>({1, 3, 5}));
 	node3.detach();
 	QVERIFY(!node3.parent());
+	QCOMPARE(node3.subKey(), 0);
 	QCOMPARE(node5.parent(), node3);
 	QCOMPARE(node6.parent(), node3);
+	QCOMPARE(node5.subKey(), 5);
+	QCOMPARE(node5.key(), QList<int>{5});
 	QCOMPARE(node1.containsChild(3), false);
 	// drop node5
 	node5.drop();
@@ -300,6 +356,40 @@ void QGenericTreeTest::testTreeBasics()
 	cloned[L2(0, 2)] = 42;
 	QCOMPARE(*tree[L2(0, 2)], 2);
 	QCOMPARE(*cloned[L2(0, 2)], 42);
+	// nodes taken before cloning stay valid and only change their own tree
+	auto node2 = tree[L2(0, 2)];
+	auto node4 = tree[L3(0, 2, 4)];
+	auto other = tree.clone();
+	*node4 = 44;
+	node4.setValue(45);
+	node2.emplaceChild(6).setValue(6);
+	QCOMPARE(*tree[L3(0, 2, 4)], 45);
+	QCOMPARE(*other[L3(0, 2, 4)], 4);
+	QCOMPARE(other.contains(L3(0, 2, 6)), false);
+	QCOMPARE(other.countElements(true), 6);
+	QCOMPARE(tree.countElements(true), 7);
+	QVERIFY(tree.begin() != tree.end());
+	QCOMPARE(tree[L3(0, 2, 4)], node4);
+	QCOMPARE(node4.parent(), node2);
+	// taking, detaching or clearing children in one tree leaves the other one alone
+	auto taken = node2.takeChild(5);
+	QVERIFY(!taken.parent());
+	const auto &constOther = other;
+	QCOMPARE(constOther.find(L3(0, 2, 5)).parent(), constOther.find(L2(0, 2)));
+	QCOMPARE(constOther.find(L3(0, 2, 5)).subKey(), 5);
+	QCOMPARE(constOther.find(L3(0, 2, 5)).key(), (QList<int>{0, 2, 5}));
+	QCOMPARE(constOther.find(L3(0, 2, 5)).depth(), 3);
+	node2.insertChild(5, taken);
+	QCOMPARE(taken.parent(), node2);
+	other[L2(0, 2)].detach();
+	other[0].clearChildren();
+	QCOMPARE(node2.parent(), tree[0]);
+	QCOMPARE(node2.childCount(), 3);
+	QCOMPARE(tree[L2(0, 3)].parent(), tree[0]);
+	QCOMPARE(tree.countElements(true), 7);
+	QCOMPARE(other.countElements(true), 2);
+	node2.removeChild(6);
+	*node4 = 4;
 	swap(tree, cloned);
 	QCOMPARE(*tree[L2(0, 2)], 42);
 	QCOMPARE(*cloned[L2(0, 2)], 2);
@@ -390,6 +480,1372 @@ void QGenericTreeTest::testIterators()
 		}
 		++cnt;
 	}
+
+	// test unordered iteration
+	TestTree uTree;
+	uTree[L3(1, 2, 3)] = 3;
+	uTree[L3(1, 2, 4)] = 4;
+	uTree[L2(1, 5)] = 5;
+	uTree[6] = 6;
+	cnt = 0;
+	for (auto it = uTree.begin(), end = uTree.end(); it != end; ++it) {
+		QCOMPARE(uTree.find(it.key()), it.node());
+		QCOMPARE(it.node().subKey(), it.subKey());
+		++cnt;
+	}
+	QCOMPARE(cnt, 6);
+	for (auto it = uTree.end(), begin = uTree.begin(); it != begin; --cnt) {
+		--it;
+		QCOMPARE(uTree.find(it.key()), it.node());
+	}
+	QCOMPARE(cnt, 0);
+}
+
+void QGenericTreeTest::testArenaAllocator()
+{
+	using ArenaTree = QOrderedTree<int, int, QGenericTreeArenaAllocator, QGenericTreeIntrusivePointerPolicy>;
+
+	ArenaTree::Node detached;
+	{
+		ArenaTree tree;
+		for (auto i = 0; i < 100; ++i) {
+			for (auto j = 0; j < 100; ++j)
+				tree[L2(i, j)] = i * j;
+		}
+		QCOMPARE(tree.countElements(), 10100);
+		QCOMPARE(*tree[L2(42, 13)], 42 * 13);
+
+		// cloned trees use their own arena
+		auto cloned = tree.clone();
+		tree.clear();
+		QCOMPARE(tree.countElements(), 0);
+		QCOMPARE(cloned.countElements(), 10100);
+		QCOMPARE(*cloned[L2(42, 13)], 42 * 13);
+
+		// freed nodes are reused
+		tree[L2(1, 2)] = 3;
+		QCOMPARE(*tree[L2(1, 2)], 3);
+
+		// nodes keep their arena alive
+		detached = cloned[7];
+		detached.detach();
+	}
+	QCOMPARE(detached.childCount(), 100);
+	QCOMPARE(*detached[99], 7 * 99);
+	detached[100] = 700;
+	QCOMPARE(*detached[100], 700);
+}
+
+void QGenericTreeTest::testIntrusivePointers()
+{
+	using IntrusiveTree = QUnorderedTree<int, int, QGenericTreeHeapAllocator, QGenericTreeIntrusivePointerPolicy>;
+	using IntrusiveArenaTree = QOrderedTree<int, int, QGenericTreeArenaAllocator, QGenericTreeIntrusivePointerPolicy>;
+
+	IntrusiveTree::Node child;
+	IntrusiveTree::WeakNode weakParent;
+	{
+		IntrusiveTree tree;
+		tree[L3(0, 1, 2)] = 2;
+		tree[L2(0, 3)] = 3;
+		QCOMPARE(tree.countElements(), 4);
+		QCOMPARE(tree[L3(0, 1, 2)].depth(), 3);
+		QCOMPARE(tree[L3(0, 1, 2)].key(), QList<int>({0, 1, 2}));
+		QCOMPARE(tree[L3(0, 1, 2)].parent(), tree[L2(0, 1)]);
+
+		auto cloned = tree.clone();
+		cloned[L2(0, 3)] = 4;
+		QCOMPARE(*tree[L2(0, 3)], 3);
+		QCOMPARE(*cloned[L2(0, 3)], 4);
+
+		child = tree[L2(0, 1)];
+		weakParent = tree[0].toWeakNode();
+		QCOMPARE(weakParent.toNode(), child.parent());
+	}
+
+	// the parent is gone, but the child and its subtree stay valid
+	QVERIFY(!weakParent);
+	QVERIFY(!weakParent.toNode());
+	QVERIFY(!child.parent());
+	QCOMPARE(child.depth(), 0);
+	QCOMPARE(child.subKey(), 0);
+	QCOMPARE(*child[2], 2);
+	QCOMPARE(child[2].parent(), child);
+	QCOMPARE(child[2].key(), QList<int>{2});
+
+	IntrusiveArenaTree arenaTree;
+	for (auto i = 0; i < 10; ++i)
+		arenaTree[L2(i, i)] = i;
+	auto cnt = 0;
+	for (auto it = arenaTree.begin(), end = arenaTree.end(); it != end; ++it) {
+		if (it)
+			QCOMPARE(*it, cnt++);
+	}
+	QCOMPARE(cnt, 10);
+	arenaTree.clear();
+	QCOMPARE(arenaTree.countElements(), 0);
+}
+
+void QGenericTreeTest::testSmallChildMap()
+{
+	using SmallTree = QSmallOrderedTree<int, int>;
+
+	// inline storage keeps the entries sorted
+	QSmallMap<int, int> map;
+	for (auto i : {3, 1, 2})
+		map.insert(i, i * 10);
+	QVERIFY(!map.isSpilled());
+	QCOMPARE(map.size(), 3);
+	QCOMPARE(map.first(), 10);
+	QCOMPARE(map.last(), 30);
+	QCOMPARE(map.value(2), 20);
+	QCOMPARE(map.value(4, -1), -1);
+	map.insert(2, 21);
+	QCOMPARE(map.size(), 3);
+	QCOMPARE(map.find(2).key(), 2);
+	QCOMPARE(*map.find(2), 21);
+
+	// spills once the inline storage is exhausted, but keeps all entries
+	for (auto i : {5, 0, 4})
+		map.insert(i, i * 10);
+	QVERIFY(map.isSpilled());
+	QCOMPARE(map.size(), 6);
+	auto expected = 0;
+	for (auto it = map.cbegin(); it != map.cend(); ++it)
+		QCOMPARE(it.key(), expected++);
+	QCOMPARE(map.take(5), 50);
+	QCOMPARE(map.remove(5), 0);
+	QCOMPARE(map.size(), 5);
+
+	auto copy = map;
+	map.clear();
+	QVERIFY(!map.isSpilled());
+	QVERIFY(map.isEmpty());
+	QCOMPARE(copy.size(), 5);
+	QCOMPARE(copy.value(3), 30);
+
+	QSmallHash<int, int> hash;
+	for (auto i = 0; i < 4; ++i)
+		hash.insert(i, i);
+	QCOMPARE(hash.take(1), 1);
+	QCOMPARE(hash.erase(hash.find(0)).key(), 2);
+	QCOMPARE(hash.size(), 2);
+	auto moved = std::move(hash);
+	QVERIFY(hash.isEmpty());
+	QCOMPARE(moved.value(2), 2);
+	QCOMPARE(moved.value(3), 3);
+
+	// trees work the same whether the children are stored inline or spilled
+	SmallTree tree;
+	for (auto i = 0; i < 10; ++i) {
+		tree[L2(i % 2, i)] = i;
+		QCOMPARE(tree[L2(i % 2, i)].subKey(), i);
+	}
+	QCOMPARE(tree.countElements(), 12);
+	QCOMPARE(tree[0].childCount(), 5);
+	auto cnt = 0;
+	for (auto it = tree.begin(), end = tree.end(); it != end; ++it) {
+		if (it) {
+			QCOMPARE(it.key(), QList<int>({cnt % 2, cnt}));
+			cnt += 2;
+			if (cnt == 10)
+				cnt = 1;
+		}
+	}
+	QCOMPARE(cnt, 11);
+	auto rcnt = 0;
+	for (auto it = tree.end(), begin = tree.begin(); it != begin;) {
+		--it;
+		if (it)
+			++rcnt;
+	}
+	QCOMPARE(rcnt, 10);
+
+	auto cloned = tree.clone();
+	tree[L2(0, 4)].detach();
+	QCOMPARE(tree[0].childCount(), 4);
+	QCOMPARE(cloned[0].childCount(), 5);
+	QCOMPARE(*cloned[L2(0, 4)], 4);
+	tree[1].clearChildren();
+	QVERIFY(!tree[1].hasChildren());
+	QCOMPARE(tree.countElements(), 6);
+}
+
+void QGenericTreeTest::testFlatMap()
+{
+	QFlatMap<int, int> map;
+	for (auto i : {4, 1, 3, 0, 2})
+		map.insert(i, i * 10);
+	map.insert(3, 31);
+	QCOMPARE(map.size(), 5);
+	QCOMPARE(map.first(), 0);
+	QCOMPARE(map.last(), 40);
+	QCOMPARE(map.value(3), 31);
+	QCOMPARE(map.value(5, -1), -1);
+	QVERIFY(map.contains(2));
+	QVERIFY(map.find(5) == map.end());
+	auto expected = 0;
+	for (auto it = map.cbegin(); it != map.cend(); ++it)
+		QCOMPARE(it.key(), expected++);
+
+	auto copy = map;
+	*copy.find(0) = 1;
+	QCOMPARE(map.value(0), 0);
+	QCOMPARE(copy.value(0), 1);
+	QCOMPARE(map.erase(map.find(1)).key(), 2);
+	QCOMPARE(map.take(4), 40);
+	QCOMPARE(map.remove(4), 0);
+	QCOMPARE(map.size(), 3);
+	QCOMPARE(copy.size(), 5);
+
+	// same tree as in testIterators, but inserted in a different order
+	//   /-8 /-7 /-6
+	// r---1---3---5
+	//   \-0 \-2 \-4
+	QFlatOrderedTree<int, int> tree;
+	tree[8] = 8;
+	tree[1][7] = 7;
+	tree[1][3][6] = 6;
+	tree[1][3][4] = 4;
+	tree[1][3][5] = 5;
+	tree[1][3] = 3;
+	tree[1][2] = 2;
+	tree[1] = 1;
+	tree[0] = 0;
+
+	auto cnt = 0;
+	for (const auto &value : qAsConst(tree))
+		QCOMPARE(value, cnt++);
+	QCOMPARE(cnt, 9);
+	for (auto it = tree.end(), begin = tree.begin(); it != begin;) {
+		--it;
+		QCOMPARE(*it, --cnt);
+	}
+	QCOMPARE(tree.find(L3(1, 3, 5)).key(), QList<int>({1, 3, 5}));
+	QCOMPARE(tree[L3(1, 3, 5)].subKey(), 5);
+	QCOMPARE(tree.rootNode().findChild(L2(1, 7)), tree[L2(1, 7)]);
+
+	auto cloned = tree.clone();
+	tree[1][3].detach();
+	QCOMPARE(tree.countElements(), 5);
+	QCOMPARE(cloned.countElements(), 9);
+	QCOMPARE(*cloned[L3(1, 3, 6)], 6);
+}
+
+void QGenericTreeTest::testFlatHash()
+{
+	// compare against a QHash across growing, tombstones and reuse of slots
+	QFlatHash<int, int> hash;
+	QHash<int, int> reference;
+	QVERIFY(hash.begin() == hash.end());
+	QVERIFY(!hash.contains(0));
+	for (auto i = 0; i < 1000; ++i) {
+		hash.insert(i * 7, i);
+		reference.insert(i * 7, i);
+		if (i % 3 == 0) {
+			QCOMPARE(hash.take((i / 2) * 7), reference.take((i / 2) * 7));
+			QCOMPARE(hash.remove(-1), 0);
+		}
+	}
+	hash.insert(7, 42);
+	reference.insert(7, 42);
+	QCOMPARE(hash.size(), reference.size());
+	for (auto it = reference.cbegin(); it != reference.cend(); ++it)
+		QCOMPARE(hash.value(it.key(), -1), *it);
+	auto cnt = 0;
+	for (auto it = hash.cbegin(); it != hash.cend(); ++it, ++cnt)
+		QCOMPARE(reference.value(it.key(), -1), *it);
+	QCOMPARE(cnt, reference.size());
+	for (auto it = hash.cend(); it != hash.cbegin(); ++cnt)
+		--it;
+	QCOMPARE(cnt, reference.size() * 2);
+
+	// erase every other entry while iterating
+	auto copy = hash;
+	for (auto it = hash.begin(); it != hash.end();) {
+		if (it.key() % 2 == 0) {
+			reference.remove(it.key());
+			it = hash.erase(it);
+		} else
+			++it;
+	}
+	QCOMPARE(hash.size(), reference.size());
+	for (auto it = reference.cbegin(); it != reference.cend(); ++it)
+		QCOMPARE(hash.value(it.key(), -1), *it);
+	QVERIFY(copy.size() > hash.size());
+	QCOMPARE(copy.value(14), 2);
+
+	auto moved = std::move(copy);
+	QVERIFY(copy.isEmpty());
+	QCOMPARE(moved.value(14), 2);
+	moved.clear();
+	QVERIFY(moved.isEmpty());
+	QVERIFY(!moved.contains(14));
+
+	QFlatUnorderedTree<int, int> tree;
+	for (auto i = 0; i < 100; ++i)
+		tree[L2(i % 3, i)] = i;
+	QCOMPARE(tree.countElements(), 103);
+	QCOMPARE(tree[1].childCount(), 33);
+	QCOMPARE(tree[L2(2, 50)].key(), QList<int>({2, 50}));
+	cnt = 0;
+	for (auto it = tree.begin(), end = tree.end(); it != end; ++it) {
+		if (it) {
+			QCOMPARE(it.key(), QList<int>({*it % 3, *it}));
+			++cnt;
+		}
+	}
+	QCOMPARE(cnt, 100);
+
+	auto cloned = tree.clone();
+	tree[L2(1, 4)].detach();
+	QCOMPARE(tree[1].childCount(), 32);
+	QCOMPARE(*cloned[L2(1, 4)], 4);
+}
+
+void QGenericTreeTest::testSubtreeCounters()
+{
+	TestTree tree;
+	const auto iterCount = [](const TestTree &tree, bool valueOnly) {
+		auto cnt = 0;
+		for (auto it = tree.begin(), end = tree.end(); it != end; ++it) {
+			if (!valueOnly || it)
+				++cnt;
+		}
+		return cnt;
+	};
+	const auto verify = [&](const TestTree &tree) {
+		return tree.countElements() == iterCount(tree, false) &&
+			tree.countElements(true) == iterCount(tree, true);
+	};
+
+	QCOMPARE(tree.countElements(), 0);
+	QCOMPARE(tree.rootNode().subtreeSize(), 1);
+	tree[L3(0, 1, 2)] = 2;
+	tree[L2(0, 3)] = 3;
+	QVERIFY(verify(tree));
+	QCOMPARE(tree.countElements(), 4);
+	QCOMPARE(tree.countElements(true), 2);
+	QCOMPARE(tree[0].subtreeSize(), 4);
+	QCOMPARE(tree[0].subtreeSize(true), 2);
+
+	// values
+	auto node0 = tree[0];
+	node0.setValue(0);
+	*tree[L2(0, 1)] = 1;
+	QCOMPARE(tree.countElements(true), 4);
+	node0 = 5;
+	QCOMPARE(tree.countElements(true), 4);
+	QCOMPARE(node0.takeValue(), 5);
+	tree[L2(0, 3)].clearValue();
+	tree[L2(0, 3)].clearValue();
+	QCOMPARE(tree.countElements(true), 2);
+	QCOMPARE(node0.subtreeSize(true), 2);
+	QVERIFY(verify(tree));
+
+	// children
+	auto node1 = node0.takeChild(1);
+	QCOMPARE(tree.countElements(), 2);
+	QCOMPARE(node1.subtreeSize(), 2);
+	QCOMPARE(node1.subtreeSize(true), 2);
+	node0.insertChild(4, node1);
+	QCOMPARE(tree.countElements(), 4);
+	QCOMPARE(tree.countElements(true), 2);
+	node0.emplaceChild(4) = 4;
+	QCOMPARE(tree.countElements(), 3);
+	QCOMPARE(tree.countElements(true), 1);
+	QVERIFY(verify(tree));
+	tree[L3(0, 4, 5)] = 5;
+	QVERIFY(node0.removeChild(3));
+	QVERIFY(!node0.removeChild(3));
+	QCOMPARE(tree.countElements(), 3);
+	QVERIFY(verify(tree));
+
+	// moving a subtree between parents updates both
+	tree[L2(1, 6)] = 6;
+	auto node4 = tree[L2(0, 4)];
+	tree[1].insertChild(4, node4);
+	QCOMPARE(tree[0].subtreeSize(), 1);
+	QCOMPARE(tree[1].subtreeSize(), 4);
+	QCOMPARE(tree[1].subtreeSize(true), 3);
+	node4.detach();
+	QCOMPARE(tree[1].subtreeSize(), 2);
+	QCOMPARE(tree.countElements(), 3);
+	QVERIFY(verify(tree));
+
+	auto cloned = tree.clone();
+	QCOMPARE(cloned.countElements(), 3);
+	QCOMPARE(cloned.countElements(true), 1);
+	tree[1].clearChildren();
+	QCOMPARE(tree[1].subtreeSize(), 1);
+	QCOMPARE(tree.countElements(), 2);
+	QCOMPARE(cloned.countElements(), 3);
+	tree.clear();
+	QCOMPARE(tree.countElements(), 0);
+	QCOMPARE(tree.countElements(true), 0);
+	QVERIFY(verify(cloned));
+}
+
+void QGenericTreeTest::testKeyRanges()
+{
+	TestTree tree;
+	tree[L3(0, 1, 2)] = 2;
+	const auto node = tree[L3(0, 1, 2)];
+
+	// initializer lists
+	QCOMPARE(tree.find(L3(0, 1, 2)), node);
+	QCOMPARE(qAsConst(tree).find(L3(0, 1, 2)), node);
+	QCOMPARE(qAsConst(tree)[L3(0, 1, 2)], node);
+	QVERIFY(tree.contains(L2(0, 1)));
+	QVERIFY(!tree.contains(L2(0, 2)));
+	QCOMPARE(tree[0].findChild(L2(1, 2)), node);
+	QCOMPARE(tree.find({}), tree.rootNode());
+
+	// arrays, vectors and iterator pairs
+	const int path[] = {0, 1, 2};
+	QCOMPARE(tree.find(path), node);
+	QCOMPARE(tree.find(std::begin(path), std::end(path)), node);
+	QCOMPARE(tree.find(std::begin(path), std::begin(path) + 2), tree[0][1]);
+	QVERIFY(tree.contains(std::begin(path) + 1, std::end(path)) == false);
+	QCOMPARE(tree.rootNode().findChild(std::begin(path), std::end(path)), node);
+	const QVector<int> vector {0, 1};
+	QCOMPARE(tree.find(vector), tree[0][1]);
+	QVERIFY(tree.contains(QGenericTreeKeySpan<int>{vector}));
+	const QGenericTreeKeySpan<int> span{path, 2};
+	QCOMPARE(qAsConst(tree)[span], tree[0][1]);
+
+	// spans over views of a larger buffer
+	const int buffer[] = {0, 3, 4, 5};
+	tree[QGenericTreeKeySpan<int>(buffer, 3)] = 4;
+	QCOMPARE(tree.countElements(), 5);
+	QCOMPARE(*tree[L3(0, 3, 4)], 4);
+	QVERIFY(!tree.contains(QGenericTreeKeySpan<int>(buffer, 4)));
+	tree[{0, 3, 4, 5}] = 5;
+	QVERIFY(tree.contains(buffer));
+	QCOMPARE(tree.countElements(), 6);
+}
+
+void QGenericTreeTest::testHeterogeneousLookup()
+{
+	QFlatOrderedTree<QString, int> ordered;
+	ordered[{QStringLiteral("usr"), QStringLiteral("lib"), QStringLiteral("qt")}] = 1;
+	QFlatUnorderedTree<QString, int> unordered;
+	unordered[{QStringLiteral("usr"), QStringLiteral("lib"), QStringLiteral("qt")}] = 1;
+
+	// views into a buffer, without creating a QString for each key
+	const QString buffer = QStringLiteral("usr/lib/qt");
+	const QVector<QStringView> path {
+		QStringView{buffer}.mid(0, 3),
+		QStringView{buffer}.mid(4, 3),
+		QStringView{buffer}.mid(8, 2)
+	};
+	const QVector<QStringView> missing {QStringView{buffer}.mid(0, 3), QStringView{buffer}.mid(8, 2)};
+
+	// single children
+	QCOMPARE(ordered.rootNode().child(path[0]), ordered[QStringLiteral("usr")]);
+	QVERIFY(qAsConst(ordered).rootNode().containsChild(QLatin1String("usr")));
+	QVERIFY(!ordered.rootNode().containsChild(QLatin1String("lib")));
+	QVERIFY(!ordered[QStringLiteral("usr")].child(path[2]));
+	QCOMPARE(unordered.rootNode().child(path[0]), unordered[QStringLiteral("usr")]);
+	QVERIFY(qAsConst(unordered).rootNode().containsChild(QLatin1String("usr")));
+	QVERIFY(!unordered.rootNode().containsChild(QLatin1String("lib")));
+	QVERIFY(!unordered[QStringLiteral("usr")].child(path[2]));
+
+	// key paths
+	QCOMPARE(*ordered.find(path.cbegin(), path.cend()), 1);
+	QVERIFY(!ordered.contains(missing.cbegin(), missing.cend()));
+	QCOMPARE(*qAsConst(ordered).find({QLatin1String("usr"), QLatin1String("lib"), QLatin1String("qt")}), 1);
+	QVERIFY(ordered.contains({path[0], path[1]}));
+	QCOMPARE(ordered[QStringLiteral("usr")].findChild({path[1], path[2]}), ordered.find(path.cbegin(), path.cend()));
+	QCOMPARE(*unordered.find(path.cbegin(), path.cend()), 1);
+	QVERIFY(!unordered.contains(missing.cbegin(), missing.cend()));
+	QCOMPARE(*qAsConst(unordered).find({QLatin1String("usr"), QLatin1String("lib"), QLatin1String("qt")}), 1);
+	QVERIFY(unordered.contains({path[0], path[1]}));
+	QCOMPARE(unordered[QStringLiteral("usr")].findChild({path[1], path[2]}), unordered.find(path.cbegin(), path.cend()));
+
+	// lookups with the key type itself are unchanged
+	QVERIFY(ordered.contains({QStringLiteral("usr"), QStringLiteral("lib")}));
+	QVERIFY(unordered.rootNode().containsChild(QStringLiteral("usr")));
+}
+
+void QGenericTreeTest::testPathTree()
+{
+	QPathTree<int> tree;
+	QCOMPARE(tree.separator(), QLatin1Char('/'));
+	QVERIFY(!tree.contains(u"a/b"));
+	QCOMPARE(tree.find(QStringView{}), tree.rootNode());
+	QCOMPARE(tree.find(u"/"), tree.rootNode());
+
+	// paths create all missing nodes, empty segments are skipped
+	tree[u"a/b/c"] = 1;
+	tree[u"/a//d/"] = 2;
+	tree[QStringLiteral("e")] = 3;
+	QCOMPARE(tree.countElements(), 5);
+	QCOMPARE(tree.countElements(true), 3);
+	QVERIFY(tree.contains(u"a/b"));
+	QVERIFY(tree.contains(u"a/b/c/"));
+	QVERIFY(!tree.contains(u"a/c"));
+	QVERIFY(!tree.contains(u"a/b/c/d"));
+	QCOMPARE(*tree.find(u"a/b/c"), 1);
+	QCOMPARE(*qAsConst(tree).find(u"a/d"), 2);
+	QCOMPARE(*qAsConst(tree)[u"e"], 3);
+	QVERIFY(!qAsConst(tree)[u"f"]);
+	QCOMPARE(tree.tree().find({QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c")}), tree.find(u"a/b/c"));
+
+	// existing nodes are reused
+	const auto node = tree[u"a/b"];
+	QCOMPARE(tree[u"a/b"], node);
+	QCOMPARE(tree.countElements(), 5);
+
+	// splitting a path into views of the same buffer
+	const QString path = QStringLiteral("x//y/z");
+	QStringList segments;
+	for (auto it = tree.segmentsBegin(path), end = tree.segmentsEnd(); it != end; ++it) {
+		QVERIFY(it->data() >= path.constData() && it->data() < path.constData() + path.size());
+		segments.append(it->toString());
+	}
+	QCOMPARE(segments, (QStringList{QStringLiteral("x"), QStringLiteral("y"), QStringLiteral("z")}));
+
+	// iteration rebuilds the paths
+	QStringList paths;
+	for (auto it = tree.begin(); it != tree.end(); ++it)
+		paths.append(it.path());
+	QCOMPARE(paths, (QStringList{
+		QStringLiteral("a"),
+		QStringLiteral("a/b"),
+		QStringLiteral("a/b/c"),
+		QStringLiteral("a/d"),
+		QStringLiteral("e")
+	}));
+	auto it = qAsConst(tree).end();
+	--it;
+	QCOMPARE(it.path(), QStringLiteral("e"));
+	QCOMPARE(*it, 3);
+
+	// other separators
+	QPathTree<int, QFlatHash> dotted{QLatin1Char('.')};
+	dotted[u"org.qt.core"] = 4;
+	QVERIFY(dotted.contains(u"org.qt"));
+	QVERIFY(!dotted.contains(u"org/qt"));
+	QCOMPARE((++dotted.begin()).path(), QStringLiteral("org.qt"));
+}
+
+void QGenericTreeTest::testFromSorted()
+{
+	const QList<QPair<QList<int>, int>> entries {
+		{{}, 0},
+		{L2(0, 1), 1},
+		{L3(0, 1, 2), 2},
+		{L3(0, 1, 3), 3},
+		{L3(0, 1, 3), 4},
+		{L2(0, 4), 5},
+		{{5}, 6},
+		{L3(5, 6, 7), 7}
+	};
+
+	// the same entries, inserted one by one
+	QOrderedTree<int, int> expected;
+	for (const auto &entry : entries)
+		*expected[entry.first] = entry.second;
+
+	const auto tree = QOrderedTree<int, int>::fromSorted(entries.cbegin(), entries.cend());
+	QCOMPARE(tree.countElements(), expected.countElements());
+	QCOMPARE(tree.countElements(true), expected.countElements(true));
+	QCOMPARE(tree.countElements(), 8);
+	QCOMPARE(tree.countElements(true), 6);
+	QCOMPARE(*tree.rootNode(), 0);
+	QCOMPARE(*tree[L3(0, 1, 3)], 4);
+	QVERIFY(!tree[0].hasValue());
+	QCOMPARE(tree[0].subtreeSize(), 5);
+	QCOMPARE(tree[0].subtreeSize(true), 4);
+	for (auto it = tree.begin(), exIt = qAsConst(expected).begin(); it != tree.end(); ++it, ++exIt) {
+		QVERIFY(exIt != qAsConst(expected).end());
+		QCOMPARE(it.key(), exIt.key());
+		QCOMPARE(it.node().key(), it.key());
+		QCOMPARE(static_cast<bool>(it), static_cast<bool>(exIt));
+		if (it)
+			QCOMPARE(*it, *exIt);
+	}
+
+	// grouped paths are enough for unordered containers
+	const std::vector<std::pair<QVector<int>, int>> grouped {
+		{{3, 2}, 1},
+		{{3, 1}, 2},
+		{{1}, 3},
+		{{1, 9, 8}, 4}
+	};
+	const auto unordered = TestTree::fromSorted(grouped.begin(), grouped.end());
+	QCOMPARE(unordered.countElements(), 6);
+	QCOMPARE(unordered.countElements(true), 4);
+	QCOMPARE(*unordered[L2(3, 1)], 2);
+	QCOMPARE(*unordered[L3(1, 9, 8)], 4);
+	QCOMPARE(unordered[L3(1, 9, 8)].parent(), unordered[L2(1, 9)]);
+
+	// and the flat map appends with a position hint
+	const auto flat = QFlatOrderedTree<int, int>::fromSorted(entries.cbegin(), entries.cend());
+	QCOMPARE(flat.countElements(), 8);
+	QCOMPARE(flat.countElements(true), 6);
+	QCOMPARE(*flat[L3(5, 6, 7)], 7);
+	QCOMPARE(flat[5].subtreeSize(true), 2);
+
+	// entries that break the grouping are merged into the nodes created before
+	const std::vector<std::pair<QVector<int>, int>> scattered {
+		{{3, 2}, 1},
+		{{1}, 2},
+		{{3, 2, 4}, 3},
+		{{3}, 4},
+		{{1}, 5}
+	};
+	const auto merged = TestTree::fromSorted(scattered.begin(), scattered.end());
+	QCOMPARE(merged.countElements(), 4);
+	QCOMPARE(merged.countElements(true), 4);
+	QCOMPARE(merged[3].subtreeSize(), 3);
+	QCOMPARE(merged[3].subtreeSize(true), 3);
+	QCOMPARE(*merged[1], 5);
+	QCOMPARE(*merged[L3(3, 2, 4)], 3);
+	// ordered containers only look up the keys that do not come after the last child
+	const auto mergedOrdered = QOrderedTree<int, int>::fromSorted(scattered.begin(), scattered.end());
+	QCOMPARE(mergedOrdered.countElements(), 4);
+	QCOMPARE(mergedOrdered.countElements(true), 4);
+	QCOMPARE(mergedOrdered[3].subtreeSize(true), 3);
+	QCOMPARE(*mergedOrdered[1], 5);
+	QCOMPARE(mergedOrdered.rootNode().childCount(), 2);
+
+	const auto empty = TestTree::fromSorted(grouped.end(), grouped.end());
+	QCOMPARE(empty.countElements(), 0);
+}
+
+void QGenericTreeTest::testParallelAlgorithms()
+{
+	// one heavy subtree, so it has to be split up, and a few light ones
+	TestTree tree;
+	*tree.rootNode() = 1000000;
+	auto serialSum = 0ll;
+	for (auto i = 0; i < 100; ++i) {
+		for (auto j = 0; j < 100; ++j) {
+			auto node = tree[L3(0, i, j)];
+			node = i * 100 + j;
+			serialSum += *node;
+		}
+	}
+	for (auto i = 1; i < 5; ++i) {
+		tree[i] = -i;
+		serialSum -= i;
+	}
+	QCOMPARE(tree.countElements(true), 10004);
+
+	const auto sum = qAsConst(tree).parallelReduce([](int value) {
+		return static_cast<qint64>(value);
+	}, [](qint64 &result, qint64 value) {
+		result += value;
+	});
+	QCOMPARE(sum, serialSum);
+
+	// the reduction keeps the preorder
+	QOrderedTree<int, int> ordered;
+	for (auto i = 0; i < 3000; ++i)
+		*ordered[L2(i % 3, i)] = i;
+	const auto list = ordered.parallelReduce([](int value) {
+		return QVector<int>{value};
+	}, [](QVector<int> &result, const QVector<int> &values) {
+		result.append(values);
+	});
+	QCOMPARE(list.size(), 3000);
+	auto expected = ordered.begin();
+	for (const auto value : list) {
+		while (!expected)
+			++expected;
+		QCOMPARE(value, *expected);
+		++expected;
+	}
+
+	QAtomicInt count;
+	qAsConst(tree).parallelForEach([&count](const int &) {
+		count.ref();
+	});
+	QCOMPARE(count.loadAcquire(), 10004);
+
+	tree.parallelMapValues([](int value) {
+		return value * 2;
+	});
+	QCOMPARE(*tree.rootNode(), 1000000);
+	QCOMPARE(*tree[L3(0, 99, 99)], 19998);
+	QCOMPARE(*tree[4], -8);
+
+	tree.parallelForEach([](int &value) {
+		value /= 2;
+	});
+	QCOMPARE(*tree[L3(0, 42, 7)], 4207);
+
+	// nodes include their own value
+	auto subtree = tree[L2(0, 42)];
+	subtree = 5;
+	QCOMPARE(qAsConst(subtree).parallelReduce([](int value) {
+		return value;
+	}, [](int &result, int value) {
+		result += value;
+	}, 1), 1 + 5 + 4200 * 100 + 99 * 50);
+	subtree.parallelMapValues([](int value) {
+		return -value;
+	});
+	QCOMPARE(*subtree, -5);
+	QCOMPARE(*tree[L3(0, 42, 1)], -4201);
+	QCOMPARE(*tree[L3(0, 41, 1)], 4101);
+}
+
+void QGenericTreeTest::testParallelClone()
+{
+	using IntrusiveArenaTree = QOrderedTree<int, int, QGenericTreeArenaAllocator, QGenericTreeIntrusivePointerPolicy>;
+
+	// one heavy subtree, so it has to be split up, and a few light ones
+	IntrusiveArenaTree tree;
+	*tree.rootNode() = 42;
+	for (auto i = 0; i < 100; ++i) {
+		for (auto j = 0; j < 50; ++j)
+			*tree[L3(0, i, j)] = i * 100 + j;
+	}
+	for (auto i = 1; i < 5; ++i)
+		*tree[L2(i, i)] = -i;
+
+	const auto serial = tree.clone();
+	const auto cloned = tree.clone(QGenericTreeParallel);
+	QCOMPARE(cloned.countElements(), tree.countElements());
+	QCOMPARE(cloned.countElements(true), tree.countElements(true));
+	QCOMPARE(*cloned.rootNode(), 42);
+	QVERIFY(!cloned.rootNode().parent());
+	for (auto it = cloned.begin(), sIt = serial.begin(); it != cloned.end(); ++it, ++sIt) {
+		QVERIFY(sIt != serial.end());
+		QCOMPARE(it.key(), sIt.key());
+		QCOMPARE(it.node().key(), it.key());
+		QCOMPARE(it.node().subtreeSize(), sIt.node().subtreeSize());
+		QCOMPARE(it.node().subtreeSize(true), sIt.node().subtreeSize(true));
+		QCOMPARE(static_cast<bool>(it), static_cast<bool>(sIt));
+		if (it)
+			QCOMPARE(*it, *sIt);
+	}
+	QCOMPARE(cloned[L3(0, 42, 7)].parent(), cloned[L2(0, 42)]);
+	QCOMPARE(cloned[L2(0, 42)].parent(), cloned[0]);
+	QCOMPARE(cloned[0].parent(), cloned.rootNode());
+
+	// the clone is independent of the original
+	*tree[L3(0, 42, 7)] = -1;
+	QCOMPARE(*cloned[L3(0, 42, 7)], 4207);
+
+	// nodes are cloned without their parent
+	const auto node = tree[0].clone(QGenericTreeParallel);
+	QVERIFY(!node.parent());
+	QCOMPARE(node.subtreeSize(), 1 + 100 + 100 * 50);
+	QCOMPARE(*node.findChild(L2(42, 7)), -1);
+	QCOMPARE(node.findChild(L2(42, 7)).key(), QList<int>(L2(42, 7)));
+}
+
+void QGenericTreeTest::testConcurrentTree()
+{
+	using ConcurrentTree = QConcurrentTree<int, int>;
+
+	ConcurrentTree tree;
+	tree.setValue(L2(1, 2), 12);
+	tree.setValue(L2(3, 4), 34);
+	const auto first = tree.snapshot();
+	QCOMPARE(first.countElements(), 4);
+	QCOMPARE(*first[L2(1, 2)], 12);
+
+	// later writes are not visible in earlier snapshots, and unchanged subtrees are shared
+	tree.setValue(L3(1, 2, 5), 125);
+	tree.setValue(L2(1, 2), 21);
+	const auto second = tree.snapshot();
+	QCOMPARE(first.countElements(), 4);
+	QCOMPARE(*first[L2(1, 2)], 12);
+	QVERIFY(!first.contains(L3(1, 2, 5)));
+	QCOMPARE(second.countElements(), 5);
+	QCOMPARE(second.countElements(true), 3);
+	QCOMPARE(*second[L2(1, 2)], 21);
+	QCOMPARE(*second[L3(1, 2, 5)], 125);
+	QCOMPARE(second[1].subtreeSize(), 3);
+	QCOMPARE(second[3], first[3]);
+	QVERIFY(second[1] != first[1]);
+	QCOMPARE(second[L2(1, 2)][5], second[L3(1, 2, 5)]);
+
+	// shared nodes have no parent in the newer versions, so the keys come from the way down
+	QList<QList<int>> keys;
+	for (auto it = second.begin(); it != second.end(); ++it) {
+		keys.append(it.key());
+		QCOMPARE(it.node().subKey(), it.subKey());
+	}
+	QCOMPARE(keys, (QList<QList<int>>{{1}, L2(1, 2), L3(1, 2, 5), {3}, L2(3, 4)}));
+
+	QCOMPARE(tree.clearValue(L2(3, 4)), true);
+	QCOMPARE(tree.clearValue(L2(3, 4)), false);
+	QCOMPARE(tree.remove(L2(4, 4)), false);
+	QCOMPARE(tree.remove({1}), true);
+	const auto third = tree.snapshot();
+	QCOMPARE(third.countElements(), 2);
+	QCOMPARE(third.countElements(true), 0);
+	QCOMPARE(*second[L3(1, 2, 5)], 125);
+	QCOMPARE(*first[L2(3, 4)], 34);
+
+	// a batch is published at once, and changes nodes created in the same batch in place
+	tree.update([](ConcurrentTree::Writer &writer) {
+		for (auto i = 0; i < 10; ++i)
+			writer.setValue(L2(5, i), i);
+		writer.setValue({5}, 5);
+		QCOMPARE(writer.countElements(), 13);
+	});
+	QCOMPARE(tree.snapshot().countElements(), 13);
+	QCOMPARE(tree.snapshot().countElements(true), 11);
+	QCOMPARE(third.countElements(), 2);
+
+	// readers always see whole batches, which keep the sum of the new values at zero
+	std::atomic<bool> done{false};
+	std::atomic<int> failures{0};
+	std::vector<std::thread> readers;
+	for (auto i = 0; i < 4; ++i) {
+		readers.emplace_back([&]() {
+			while (!done.load()) {
+				const auto snapshot = tree.snapshot();
+				auto sum = 0;
+				for (auto it = snapshot.begin(), end = snapshot.end(); it != end; ++it) {
+					if (it)
+						sum += *it;
+				}
+				if (sum != 45 + 5)
+					++failures;
+			}
+		});
+	}
+	for (auto i = 0; i < 1000; ++i) {
+		tree.update([i](ConcurrentTree::Writer &writer) {
+			writer.setValue(L2(6, i % 10), i);
+			writer.setValue(L2(7, i % 10), -i);
+			if (i % 100 == 99)
+				writer.remove(L2(6, (i / 100) % 10));
+			if (i % 100 == 99)
+				writer.remove(L2(7, (i / 100) % 10));
+		});
+	}
+	done = true;
+	for (auto &reader : readers)
+		reader.join();
+	QCOMPARE(failures.load(), 0);
+}
+
+void QGenericTreeTest::testNodeLocks()
+{
+	using LockedTree = QUnorderedTree<int, int, QGenericTreeHeapAllocator, QGenericTreeSharedPointerPolicy, QGenericTreeNodeLockPolicy>;
+
+	// the single threaded behaviour is the same
+	LockedTree tree;
+	*tree[L2(1, 2)] = 12;
+	tree[1].emplaceChild(3) = 13;
+	QCOMPARE(tree.countElements(), 3);
+	QCOMPARE(tree.countElements(true), 2);
+	QCOMPARE(tree[1].takeChild(3).subKey(), 0);
+	QCOMPARE(tree.countElements(), 2);
+
+	// every thread changes a subtree of its own, all of them below the same root
+	constexpr auto ThreadCount = 8;
+	constexpr auto Count = 200;
+	std::atomic<int> failures{0};
+	std::vector<std::thread> threads;
+	for (auto t = 0; t < ThreadCount; ++t) {
+		threads.emplace_back([&tree, &failures, t]() {
+			auto branch = tree.rootNode()[t + 10];
+			for (auto i = 0; i < Count; ++i) {
+				tree[L3(t + 10, i, 0)] = i;
+				auto child = branch[i].emplaceChild(1);
+				child.setValue(-i);
+				branch[i].insertChild(2, LockedTree::Node{});
+				if (i % 2 == 0)
+					branch[i].removeChild(1);
+				else
+					child.clearValue();
+				if (tree.find(L3(t + 10, i, 0)).value(-1) != i)
+					++failures;
+			}
+		});
+	}
+	for (auto &thread : threads)
+		thread.join();
+	QCOMPARE(failures.load(), 0);
+
+	// per thread: the branch, Count children with two or three children each, and one value per child
+	QCOMPARE(tree.countElements(), 2 + ThreadCount * (1 + Count + Count * 2 + Count / 2));
+	QCOMPARE(tree.countElements(true), 1 + ThreadCount * Count);
+	for (auto t = 0; t < ThreadCount; ++t) {
+		const auto branch = qAsConst(tree)[t + 10];
+		QCOMPARE(branch.childCount(), Count);
+		QCOMPARE(branch.subtreeSize(), 1 + Count + Count * 2 + Count / 2);
+		QCOMPARE(branch.subtreeSize(true), Count);
+		QCOMPARE(branch[7][2].parent(), branch[7]);
+		QCOMPARE(branch[7][2].key(), QList<int>(L3(t + 10, 7, 2)));
+	}
+}
+
+void QGenericTreeTest::testDataStream()
+{
+	QOrderedTree<int, QString> tree;
+	*tree.rootNode() = QStringLiteral("root");
+	*tree[L3(0, 1, 2)] = QStringLiteral("a");
+	*tree[L2(0, 3)] = QStringLiteral("b");
+	*tree[4] = QString{};
+	tree[L2(5, 6)];
+
+	QByteArray data;
+	{
+		QDataStream stream{&data, QIODevice::WriteOnly};
+		stream << tree;
+	}
+	QOrderedTree<int, QString> loaded;
+	{
+		QDataStream stream{data};
+		stream >> loaded;
+		QCOMPARE(stream.status(), QDataStream::Ok);
+		QVERIFY(stream.atEnd());
+	}
+	QCOMPARE(loaded.countElements(), tree.countElements());
+	QCOMPARE(loaded.countElements(true), tree.countElements(true));
+	QCOMPARE(*loaded.rootNode(), QStringLiteral("root"));
+	QCOMPARE(loaded[0].subtreeSize(), 4);
+	QCOMPARE(loaded[0].subtreeSize(true), 2);
+	for (auto it = loaded.begin(), exIt = qAsConst(tree).begin(); it != loaded.end(); ++it, ++exIt) {
+		QVERIFY(exIt != qAsConst(tree).end());
+		QCOMPARE(it.key(), exIt.key());
+		QCOMPARE(it.node().key(), it.key());
+		QCOMPARE(static_cast<bool>(it), static_cast<bool>(exIt));
+		if (it)
+			QCOMPARE(*it, *exIt);
+	}
+
+	// the encoding does not depend on the child container
+	TestTree unordered;
+	{
+		QOrderedTree<int, int> ints;
+		*ints[L2(1, 2)] = 3;
+		*ints[4] = 5;
+		QByteArray intData;
+		QDataStream out{&intData, QIODevice::WriteOnly};
+		out << ints;
+		QDataStream in{intData};
+		in >> unordered;
+		QCOMPARE(in.status(), QDataStream::Ok);
+	}
+	QCOMPARE(unordered.countElements(), 3);
+	QCOMPARE(*unordered[L2(1, 2)], 3);
+	QCOMPARE(*unordered[4], 5);
+
+	// a repeated key is rejected and leaves an empty tree
+	QByteArray corrupt;
+	{
+		QDataStream stream{&corrupt, QIODevice::WriteOnly};
+		stream << false << qint32{2}
+			   << 7 << true << 1 << qint32{0}
+			   << 7 << true << 2 << qint32{0};
+	}
+	{
+		QDataStream stream{corrupt};
+		stream >> unordered;
+		QCOMPARE(stream.status(), QDataStream::ReadCorruptData);
+	}
+	QCOMPARE(unordered.countElements(), 0);
+
+	// so does a truncated stream
+	{
+		QDataStream stream{data.left(data.size() - 1)};
+		stream >> loaded;
+		QVERIFY(stream.status() != QDataStream::Ok);
+	}
+	QCOMPARE(loaded.countElements(), 0);
+}
+
+void QGenericTreeTest::testFrozenTree()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	const auto fileName = dir.filePath(QStringLiteral("tree.frozen"));
+
+	// children of unordered trees are sorted when frozen, so they iterate like an ordered tree
+	TestTree tree;
+	QOrderedTree<int, int> expected;
+	const QList<QList<int>> keys {L3(3, 1, 2), L2(3, 0), L2(1, 5), L3(1, 2, 4), L2(9, 9)};
+	for (const auto &key : keys) {
+		*tree[key] = key.last();
+		*expected[key] = key.last();
+	}
+	*tree.rootNode() = 42;
+	QVERIFY(QFrozenTree<int, int>::freeze(tree, fileName));
+
+	QFrozenTree<int, int> frozen{fileName};
+	QVERIFY(frozen.isOpen());
+	QCOMPARE(frozen.countElements(), expected.countElements());
+	QCOMPARE(frozen.countElements(true), expected.countElements(true));
+	QCOMPARE(*frozen.rootNode(), 42);
+	auto exIt = qAsConst(expected).begin();
+	for (auto it = frozen.begin(); it != frozen.end(); ++it, ++exIt) {
+		QVERIFY(exIt != qAsConst(expected).end());
+		QCOMPARE(it.key(), exIt.key());
+		QCOMPARE(it.node().key(), it.key());
+		QCOMPARE(it.node().depth(), it.key().size());
+		QCOMPARE(static_cast<bool>(it), static_cast<bool>(exIt));
+		if (it)
+			QCOMPARE(*it, *exIt);
+	}
+	QVERIFY(exIt == qAsConst(expected).end());
+
+	// lookups
+	const auto node = frozen.find(L3(1, 2, 4));
+	QVERIFY(node);
+	QCOMPARE(*node, 4);
+	QCOMPARE(node.subKey(), 4);
+	QCOMPARE(node.parent().key(), QList<int>(L2(1, 2)));
+	QCOMPARE(node.parent().parent().parent(), frozen.rootNode());
+	QVERIFY(!frozen.find(L2(1, 3)));
+	QVERIFY(!frozen[7]);
+	QVERIFY(frozen.contains(L2(9, 9)));
+	QVERIFY(!frozen[3].hasValue());
+	QCOMPARE(frozen[3].value(-1), -1);
+	QCOMPARE(frozen[3].childCount(), 2);
+	QCOMPARE(frozen[3].subtreeSize(), 4);
+	QCOMPARE(frozen[3].subtreeSize(true), 2);
+	const auto children = frozen[3].children();
+	QCOMPARE(children.size(), 2);
+	QCOMPARE(children[0].subKey(), 0);
+	QCOMPARE(children[1].subKey(), 1);
+	QCOMPARE(*children[1][2], 2);
+
+	// broken links of a corrupt file read as missing nodes. The records follow the 64 byte header in
+	// preorder, so the second one is the node {1}, and its parent, slot, first slot and depth are changed.
+	frozen.close();
+	{
+		QFile corrupt{fileName};
+		QVERIFY(corrupt.open(QIODevice::ReadWrite));
+		const quint32 broken = 0xFFFFFFF0;
+		for (const auto field : {0, 1, 2, 6}) {
+			QVERIFY(corrupt.seek(64 + 32 + field * 4));
+			QCOMPARE(corrupt.write(reinterpret_cast<const char*>(&broken), sizeof(broken)), qint64(sizeof(broken)));
+		}
+	}
+	QVERIFY(frozen.open(fileName));
+	QVERIFY(frozen[1]);
+	QVERIFY(!frozen[1].parent());
+	QCOMPARE(frozen[1].subKey(), 0);
+	QCOMPARE(frozen[1].key(), QList<int>());
+	QCOMPARE(frozen[1].childCount(), 0);
+	QVERIFY(frozen[1].children().isEmpty());
+	QVERIFY(!frozen.find(L2(1, 5)));
+	QCOMPARE(*frozen.find(L2(3, 0)), 0);
+
+	// only files written by freeze for the same types are accepted
+	frozen.close();
+	QVERIFY(!frozen.isOpen());
+	QVERIFY(!frozen.rootNode());
+	QVERIFY(!QFrozenTree<int, double>{fileName}.isOpen());
+	QFile file{fileName};
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QVERIFY(file.write("garbage") > 0);
+	file.close();
+	QVERIFY(!frozen.open(fileName));
+	QVERIFY(!frozen.open(dir.filePath(QStringLiteral("missing"))));
+
+	// an empty tree still has its root
+	QVERIFY(QFrozenTree<int, int>::freeze(TestTree{}, fileName));
+	QVERIFY(frozen.open(fileName));
+	QCOMPARE(frozen.countElements(), 0);
+	QVERIFY(frozen.begin() == frozen.end());
+	QVERIFY(!frozen.rootNode().hasValue());
+}
+
+void QGenericTreeTest::testCborJson()
+{
+	QOrderedTree<QString, int> tree;
+	*tree[QStringLiteral("a")] = 1;
+	*tree[{QStringLiteral("b"), QStringLiteral("c")}] = 2;
+	*tree[QStringLiteral("b")] = 3;
+	tree[{QStringLiteral("d"), QStringLiteral("e \"quoted\"\n")}];
+
+	// JSON, with the value of "b" under the empty key and "e" as null
+	QBuffer json;
+	QVERIFY(json.open(QIODevice::ReadWrite));
+	QVERIFY(QGenericTreeCbor::writeJson(&json, tree));
+	QCOMPARE(json.data(), QByteArray{R"({"a":1,"b":{"":3,"c":2},"d":{"e \"quoted\"\n":null}})"});
+	json.seek(0);
+	QOrderedTree<QString, int> fromJson;
+	QVERIFY(QGenericTreeCbor::readJson(&json, fromJson));
+	QCOMPARE(fromJson.countElements(), tree.countElements());
+	QCOMPARE(fromJson.countElements(true), tree.countElements(true));
+	for (auto it = fromJson.begin(), exIt = qAsConst(tree).begin(); it != fromJson.end(); ++it, ++exIt) {
+		QCOMPARE(it.key(), exIt.key());
+		QCOMPARE(static_cast<bool>(it), static_cast<bool>(exIt));
+		if (it)
+			QCOMPARE(*it, *exIt);
+	}
+
+	// CBOR
+	QByteArray cbor;
+	{
+		QCborStreamWriter writer{&cbor};
+		QGenericTreeCbor::writeCbor(writer, tree);
+	}
+	QCOMPARE(QCborValue::fromCbor(cbor).toJsonValue(), QJsonValue{QJsonDocument::fromJson(json.data()).object()});
+	QOrderedTree<QString, int> fromCbor;
+	{
+		QCborStreamReader reader{cbor};
+		QVERIFY(QGenericTreeCbor::readCbor(reader, fromCbor));
+	}
+	QCOMPARE(fromCbor.countElements(), tree.countElements());
+	QCOMPARE(*fromCbor[QStringLiteral("b")], 3);
+	QCOMPARE(*fromCbor[{QStringLiteral("b"), QStringLiteral("c")}], 2);
+	QVERIFY(!fromCbor[{QStringLiteral("d"), QStringLiteral("e \"quoted\"\n")}].hasValue());
+
+	// child keys that could be taken for the value key get one more backslash, and lose it when read
+	QOrderedTree<QString, int> escaped;
+	*escaped[QStringLiteral("x")] = 1;
+	*escaped[{QStringLiteral("x"), QString{}}] = 2;
+	*escaped[{QStringLiteral("x"), QStringLiteral("\\")}] = 3;
+	*escaped[{QStringLiteral("x"), QStringLiteral("a\\")}] = 4;
+	QBuffer escapedJson;
+	QVERIFY(escapedJson.open(QIODevice::ReadWrite));
+	QVERIFY(QGenericTreeCbor::writeJson(&escapedJson, escaped));
+	QCOMPARE(escapedJson.data(), QByteArray{R"({"x":{"":1,"\\":2,"\\\\":3,"a\\":4}})"});
+	QByteArray escapedCbor;
+	{
+		QCborStreamWriter writer{&escapedCbor};
+		QGenericTreeCbor::writeCbor(writer, escaped);
+	}
+	escapedJson.seek(0);
+	QOrderedTree<QString, int> unescaped;
+	QVERIFY(QGenericTreeCbor::readJson(&escapedJson, unescaped));
+	for (auto round = 0; round < 2; ++round) {
+		QCOMPARE(unescaped.countElements(), 4);
+		QCOMPARE(*unescaped[QStringLiteral("x")], 1);
+		QCOMPARE(*unescaped[{QStringLiteral("x"), QString{}}], 2);
+		QCOMPARE(*unescaped[{QStringLiteral("x"), QStringLiteral("\\")}], 3);
+		QCOMPARE(*unescaped[{QStringLiteral("x"), QStringLiteral("a\\")}], 4);
+		QCborStreamReader reader{escapedCbor};
+		QVERIFY(QGenericTreeCbor::readCbor(reader, unescaped));
+	}
+
+	// arrays become children keyed by index, and keys are converted
+	QBuffer input;
+	input.setData(R"( {"1": [10, {"2": "xä😀"}], "3": true, "4": 1.5} )");
+	QVERIFY(input.open(QIODevice::ReadOnly));
+	QOrderedTree<int, QString> converted;
+	QVERIFY(QGenericTreeCbor::readJson(&input, converted));
+	QCOMPARE(converted.countElements(), 6);
+	QCOMPARE(*converted[L2(1, 0)], QStringLiteral("10"));
+	QCOMPARE(*converted[L3(1, 1, 2)], QString::fromUtf8("xä😀"));
+	QCOMPARE(*converted[3], QStringLiteral("true"));
+	QCOMPARE(*converted[4], QStringLiteral("1.5"));
+
+	// arrays cannot be read into trees whose keys cannot be created from an index
+	QBuffer array;
+	array.setData("[1, 2]");
+	QVERIFY(array.open(QIODevice::ReadOnly));
+	QOrderedTree<QDate, int> dated;
+	QVERIFY(!QGenericTreeCbor::readJson(&array, dated));
+	{
+		QByteArray cborArray;
+		QCborStreamWriter writer{&cborArray};
+		writer.startArray(1);
+		writer.append(1);
+		writer.endArray();
+		QCborStreamReader reader{cborArray};
+		QVERIFY(!QGenericTreeCbor::readCbor(reader, dated));
+	}
+
+	// invalid documents, or keys that cannot be converted, leave the tree untouched
+	for (const auto &invalid : {"{\"a\":1,}", "{\"a\" 1}", "[1 2]", "{\"x\":1}", "{} {}", "{\"a\":tru}", ""}) {
+		QBuffer buffer;
+		buffer.setData(invalid);
+		QVERIFY(buffer.open(QIODevice::ReadOnly));
+		QVERIFY2(!QGenericTreeCbor::readJson(&buffer, converted), invalid);
+	}
+	QCOMPARE(converted.countElements(), 6);
+	{
+		QCborStreamReader reader{cbor.left(cbor.size() - 1)};
+		QVERIFY(!QGenericTreeCbor::readCbor(reader, fromCbor));
+	}
+	QCOMPARE(fromCbor.countElements(), tree.countElements());
+}
+
+void QGenericTreeTest::testBfsIterators()
+{
+	TestTree tree;
+	*tree[L3(0, 1, 2)] = 3;
+	*tree[L2(0, 4)] = 2;
+	*tree[5] = 1;
+	tree[L3(5, 6, 7)];
+	*tree[L3(5, 6, 8)] = 3;
+
+	// every node appears once, and the depths never decrease
+	QList<QList<int>> keys;
+	auto lastDepth = 1;
+	for (auto it = qAsConst(tree).bfs_begin(); it != qAsConst(tree).bfs_end(); ++it) {
+		QVERIFY(it.depth() >= lastDepth);
+		lastDepth = it.depth();
+		QCOMPARE(it.key().size(), it.depth());
+		QCOMPARE(it.node().key(), it.key());
+		QCOMPARE(it.subKey(), it.key().last());
+		QCOMPARE(static_cast<bool>(it), it.node().hasValue());
+		if (it)
+			QCOMPARE(*it, it.depth());
+		keys.append(it.key());
+	}
+	QCOMPARE(keys.size(), tree.countElements());
+	std::sort(keys.begin(), keys.end());
+	QVERIFY(std::adjacent_find(keys.begin(), keys.end()) == keys.end());
+	QCOMPARE(lastDepth, 3);
+
+	// single levels
+	QList<int> level;
+	const auto range = qAsConst(tree).levelRange(3);
+	for (auto it = range.begin(); it != range.end(); ++it)
+		level.append(it.subKey());
+	std::sort(level.begin(), level.end());
+	QCOMPARE(level, QList<int>(L3(2, 7, 8)));
+	auto levelSize = 0;
+	for (auto it = tree.levelRange(2).begin(); it != tree.bfs_end(); ++it) {
+		QCOMPARE(it.depth(), 2);
+		++levelSize;
+	}
+	QCOMPARE(levelSize, 3);
+	QVERIFY(tree.levelRange(4).begin() == tree.bfs_end());
+
+	// values can be changed, and subtrees are iterated relative to their root
+	auto node = tree[5];
+	for (auto it = node.bfs_begin(); it != node.bfs_end(); ++it)
+		it.node().setValue(it.depth() * 10);
+	QCOMPARE(*tree[L2(5, 6)], 10);
+	QCOMPARE(*tree[L3(5, 6, 7)], 20);
+	QCOMPARE(*tree[5], 1);
+	QVERIFY(node.levelRange(1).begin().node() == tree[L2(5, 6)]);
+
+	// copies iterate on their own
+	auto it = tree.bfs_begin();
+	auto copy = it;
+	++it;
+	QVERIFY(copy != it);
+	QVERIFY(++copy == it);
+	QVERIFY(TestTree{}.bfs_begin() == TestTree{}.bfs_end());
+}
+
+void QGenericTreeTest::testPostorder()
+{
+	TestTree tree;
+	*tree[L3(0, 1, 2)] = 3;
+	*tree[L2(0, 4)] = 2;
+	*tree[5] = 1;
+	tree[L3(5, 6, 7)];
+	*tree[L3(5, 6, 8)] = 3;
+
+	// every node comes after all of its children, and the root is not visited
+	QList<QList<int>> keys;
+	for (auto it = qAsConst(tree).postorder_begin(); it != qAsConst(tree).postorder_end(); ++it) {
+		QCOMPARE(it.depth(), it.key().size());
+		QCOMPARE(it.node().key(), it.key());
+		QCOMPARE(it.subKey(), it.key().last());
+		QCOMPARE(static_cast<bool>(it), it.node().hasValue());
+		if (it)
+			QCOMPARE(*it, it.depth());
+		for (const auto &child : it.node().children())
+			QVERIFY(keys.contains(child.key()));
+		QVERIFY(!keys.contains(it.key()));
+		keys.append(it.key());
+	}
+	QCOMPARE(keys.size(), tree.countElements());
+	QVERIFY(!qAsConst(tree)[keys.first()].hasChildren());
+
+	// subtrees end with their last child, and values can be changed
+	auto node = tree[L2(5, 6)];
+	auto count = 0;
+	for (auto it = node.postorder_begin(); it != node.postorder_end(); ++it) {
+		QCOMPARE(it.depth(), 1);
+		it.node().setValue(10);
+		++count;
+	}
+	QCOMPARE(count, 2);
+	QCOMPARE(*tree[L3(5, 6, 7)], 10);
+	QVERIFY(tree[L3(0, 1, 2)].postorder_begin() == tree[L3(0, 1, 2)].postorder_end());
+	QVERIFY(TestTree{}.postorder_begin() == TestTree{}.postorder_end());
+
+	// foldUp sees the results of all children
+	const auto sizes = tree.foldUp<int>([](const TestTree::ConstNode &node, const auto &childResults) {
+		auto size = 1;
+		for (const auto result : childResults)
+			size += result;
+		if (size != node.subtreeSize())
+			return -1;
+		return size;
+	});
+	QCOMPARE(sizes, tree.countElements() + 1);
+	const auto values = tree[5].foldUp<int>([](const TestTree::ConstNode &node, const auto &childResults) {
+		return std::accumulate(childResults.begin(), childResults.end(), node.value(0));
+	});
+	QCOMPARE(values, 1 + 10 + 10);
+	// bool results point into real storage as well
+	const auto allValues = tree.foldUp<bool>([](const TestTree::ConstNode &node, const auto &childResults) {
+		return (node.hasValue() || !node.hasChildren()) && std::all_of(childResults.begin(), childResults.end(), [](bool result) {
+			return result;
+		});
+	});
+	QCOMPARE(allValues, false);
+	QCOMPARE(tree[L3(5, 6, 7)].foldUp<bool>([](const TestTree::ConstNode &node, const auto &) {
+		return node.hasValue();
+	}), true);
+}
+
+void QGenericTreeTest::testFilteredIterators()
+{
+	QOrderedTree<int, int> tree;
+	*tree.rootNode() = -1;
+	*tree[L3(0, 1, 2)] = 1;
+	tree[L2(0, 3)];
+	tree[L3(4, 5, 6)];
+	*tree[4] = 2;
+	*tree[L2(7, 8)] = 3;
+	tree[9];
+
+	// the same nodes as a full preorder walk that filters
+	QList<QList<int>> valueKeys;
+	QList<QList<int>> leafKeys;
+	for (auto it = qAsConst(tree).begin(); it != qAsConst(tree).end(); ++it) {
+		if (it)
+			valueKeys.append(it.key());
+		if (!it.node().hasChildren())
+			leafKeys.append(it.key());
+	}
+
+	QList<QList<int>> keys;
+	for (auto it = qAsConst(tree).valueBegin(); it != qAsConst(tree).valueEnd(); ++it) {
+		QVERIFY(it);
+		QCOMPARE(it.node().key(), it.key());
+		QCOMPARE(it.depth(), it.key().size());
+		keys.append(it.key());
+	}
+	QCOMPARE(keys, valueKeys);
+	QCOMPARE(keys.size(), tree.countElements(true));
+
+	keys.clear();
+	for (auto it = qAsConst(tree).leafBegin(); it != qAsConst(tree).leafEnd(); ++it) {
+		QVERIFY(!it.node().hasChildren());
+		QCOMPARE(it.subKey(), it.key().last());
+		keys.append(it.key());
+	}
+	QCOMPARE(keys, leafKeys);
+	QCOMPARE(keys.size(), 5);
+
+	// values can be changed through the iterators
+	for (auto it = tree.valueBegin(); it != tree.valueEnd(); ++it)
+		*it *= 10;
+	QCOMPARE(*tree[L3(0, 1, 2)], 10);
+	QCOMPARE(*tree[4], 20);
+	QCOMPARE(*tree.rootNode(), -1);
+
+	// trees without values or children
+	tree.rootNode().clearChildren();
+	QVERIFY(tree.valueBegin() == tree.valueEnd());
+	QVERIFY(tree.leafBegin() == tree.leafEnd());
+	tree[L2(1, 2)];
+	QVERIFY(tree.valueBegin() == tree.valueEnd());
+	QCOMPARE(tree.leafBegin().key(), QList<int>(L2(1, 2)));
 }
 
 QTEST_MAIN(QGenericTreeTest)
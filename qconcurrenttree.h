@@ -0,0 +1,612 @@
+#ifndef QCONCURRENTTREE_H
+#define QCONCURRENTTREE_H
+
+#include "qgenerictreebase.h"
+
+#include <atomic>
+#include <iterator>
+
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QVector>
+
+// A tree that can be read from any number of threads while it is being written to. Readers take an
+// immutable snapshot of the latest version without locking. Writers are serialized and publish a new
+// version for every update. Only the nodes on the paths they change are copied, all other nodes are
+// shared with the earlier versions. Replaced versions are kept by the tree until a later update finds
+// that no reader of the epoch they were retired in is left, see reclaim, and their nodes are freed once
+// the last snapshot of them is gone as well. Without further updates, they stay alive.
+// As the nodes are shared, they cannot know the parent in every version, so snapshots are read from
+// the root downwards through SnapshotNodes and iterators, which have no parent and know their key
+// only from the way they were found.
+template <typename TKey, typename TValue, template<class, class> class TContainer = QMap>
+class QConcurrentTree
+{
+public:
+	// snapshots can be freed from any thread, so only atomic reference counts and the heap are used
+	using Tree = QGenericTreeBase<TKey, TValue, TContainer, QGenericTreeHeapAllocator, QGenericTreeSharedPointerPolicy>;
+
+	// a node of a snapshot, which only gives access to its value and its children
+	class SnapshotNode
+	{
+		friend class QConcurrentTree;
+
+	public:
+		explicit operator bool() const;
+		bool operator!() const;
+		bool operator==(const SnapshotNode &other) const;
+		bool operator!=(const SnapshotNode &other) const;
+
+		// value access
+		bool hasValue() const;
+		template <typename TDefault = TValue>
+		TValue value(TDefault &&defaultValue = TValue{}) const;
+		const TValue &operator*() const;
+		const TValue *operator->() const;
+
+		// child access
+		bool containsChild(const TKey &key) const;
+		int childCount() const;
+		bool hasChildren() const;
+		SnapshotNode child(const TKey &key) const;
+		SnapshotNode operator[](const TKey &key) const;
+		SnapshotNode findChild(QGenericTreeKeySpan<TKey> keys) const;
+		TKey subKey() const;
+		int subtreeSize(bool valueOnly = false) const;
+
+	private:
+		typename Tree::ConstNode _node;
+
+		explicit SnapshotNode(typename Tree::ConstNode node);
+	};
+
+	// preorder over all nodes of a snapshot but the root, like the iterators of the tree
+	class const_iterator
+	{
+		friend class QConcurrentTree;
+
+	public:
+		using value_type = const TValue;
+		using difference_type = int;
+		using pointer = value_type*;
+		using reference = value_type&;
+		using iterator_category = std::bidirectional_iterator_tag;
+
+		const_iterator() = default;
+
+		bool operator==(const const_iterator &other) const;
+		bool operator!=(const const_iterator &other) const;
+		reference operator*() const;
+		pointer operator->() const;
+		const_iterator &operator++();
+		const_iterator operator++(int);
+		const_iterator &operator--();
+		const_iterator operator--(int);
+
+		explicit operator bool() const;
+		bool operator!() const;
+		QList<TKey> key() const;
+		TKey subKey() const;
+		SnapshotNode node() const;
+
+	private:
+		typename Tree::const_iterator _it;
+
+		explicit const_iterator(typename Tree::const_iterator it);
+	};
+
+	// an immutable version of the tree, which stays valid for as long as it is kept, in any thread
+	class Snapshot
+	{
+		friend class QConcurrentTree;
+
+	public:
+		SnapshotNode rootNode() const;
+		bool contains(QGenericTreeKeySpan<TKey> keys) const;
+		int countElements(bool valueOnly = false) const;
+		SnapshotNode find(QGenericTreeKeySpan<TKey> keys) const;
+		SnapshotNode operator[](const TKey &key) const;
+		SnapshotNode operator[](QGenericTreeKeySpan<TKey> keys) const;
+
+		const_iterator begin() const;
+		const_iterator end() const;
+
+	private:
+		QSharedPointer<const Tree> _tree;
+
+		explicit Snapshot(QSharedPointer<const Tree> tree);
+	};
+
+	// collects the changes of one update, which are published together
+	class Writer
+	{
+		friend class QConcurrentTree;
+
+	public:
+		// the state of the tree with the changes so far. The nodes are only valid until the next change.
+		bool contains(QGenericTreeKeySpan<TKey> keys) const;
+		int countElements(bool valueOnly = false) const;
+		SnapshotNode find(QGenericTreeKeySpan<TKey> keys) const;
+
+		void setValue(QGenericTreeKeySpan<TKey> keys, TValue value);
+		bool clearValue(QGenericTreeKeySpan<TKey> keys);
+		bool remove(QGenericTreeKeySpan<TKey> keys);
+		void clear();
+
+	private:
+		Tree _tree;
+		QSet<const typename Tree::NodeData*> _fresh;
+
+		Writer(Tree tree);
+	};
+
+	QConcurrentTree();
+	explicit QConcurrentTree(Tree tree);
+	~QConcurrentTree();
+	Q_DISABLE_COPY(QConcurrentTree)
+
+	Snapshot snapshot() const;
+
+	template <typename TFunctor>
+	void update(TFunctor &&functor);
+	void setValue(QGenericTreeKeySpan<TKey> keys, TValue value);
+	bool clearValue(QGenericTreeKeySpan<TKey> keys);
+	bool remove(QGenericTreeKeySpan<TKey> keys);
+	void clear();
+
+private:
+	struct Version {
+		Snapshot snapshot;
+		quint32 retiredIn = 0; // the epoch in which a newer version replaced it
+	};
+
+	// readers register with the counter of the epoch they start in, which keeps writers from deleting a
+	// version while a reader copies its snapshot. See reclaim for how the epochs advance.
+	mutable std::atomic<int> _readers[2] = {{0}, {0}};
+	std::atomic<quint32> _epoch{0};
+	std::atomic<Version*> _current;
+	QMutex _writeLock;
+	QVector<Version*> _retired; // guarded by the write lock, ordered by the epoch they were retired in
+
+	void publish(Tree tree);
+	void reclaim();
+};
+
+// GENERIC IMPLEMENTATION
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::operator bool() const
+{
+	return static_cast<bool>(_node);
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::operator!() const
+{
+	return !_node;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::operator==(const SnapshotNode &other) const
+{
+	return _node == other._node;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::operator!=(const SnapshotNode &other) const
+{
+	return _node != other._node;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::hasValue() const
+{
+	return _node.hasValue();
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+template <typename TDefault>
+TValue QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::value(TDefault &&defaultValue) const
+{
+	return _node.value(std::forward<TDefault>(defaultValue));
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+const TValue &QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::operator*() const
+{
+	return *_node;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+const TValue *QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::operator->() const
+{
+	return _node.operator->();
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::containsChild(const TKey &key) const
+{
+	return _node.containsChild(key);
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+int QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::childCount() const
+{
+	return _node.childCount();
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::hasChildren() const
+{
+	return _node.hasChildren();
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::child(const TKey &key) const
+{
+	return SnapshotNode{_node.child(key)};
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::operator[](const TKey &key) const
+{
+	return SnapshotNode{_node[key]};
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::findChild(QGenericTreeKeySpan<TKey> keys) const
+{
+	return SnapshotNode{_node.findChild(keys)};
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+TKey QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::subKey() const
+{
+	return _node.subKey();
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+int QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::subtreeSize(bool valueOnly) const
+{
+	return _node.subtreeSize(valueOnly);
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode::SnapshotNode(typename Tree::ConstNode node) :
+	_node{std::move(node)}
+{}
+
+
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::const_iterator::operator==(const const_iterator &other) const
+{
+	return _it == other._it;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::const_iterator::operator!=(const const_iterator &other) const
+{
+	return _it != other._it;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::const_iterator::reference QConcurrentTree<TKey, TValue, TContainer>::const_iterator::operator*() const
+{
+	return *_it;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::const_iterator::pointer QConcurrentTree<TKey, TValue, TContainer>::const_iterator::operator->() const
+{
+	return _it.operator->();
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::const_iterator &QConcurrentTree<TKey, TValue, TContainer>::const_iterator::operator++()
+{
+	++_it;
+	return *this;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::const_iterator QConcurrentTree<TKey, TValue, TContainer>::const_iterator::operator++(int)
+{
+	auto old = *this;
+	++_it;
+	return old;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::const_iterator &QConcurrentTree<TKey, TValue, TContainer>::const_iterator::operator--()
+{
+	--_it;
+	return *this;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::const_iterator QConcurrentTree<TKey, TValue, TContainer>::const_iterator::operator--(int)
+{
+	auto old = *this;
+	--_it;
+	return old;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+QConcurrentTree<TKey, TValue, TContainer>::const_iterator::operator bool() const
+{
+	return static_cast<bool>(_it);
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::const_iterator::operator!() const
+{
+	return !_it;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+QList<TKey> QConcurrentTree<TKey, TValue, TContainer>::const_iterator::key() const
+{
+	// built from the path of the iterator, not from the parents of the node
+	return _it.key();
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+TKey QConcurrentTree<TKey, TValue, TContainer>::const_iterator::subKey() const
+{
+	return _it.subKey();
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode QConcurrentTree<TKey, TValue, TContainer>::const_iterator::node() const
+{
+	return SnapshotNode{_it.node()};
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+QConcurrentTree<TKey, TValue, TContainer>::const_iterator::const_iterator(typename Tree::const_iterator it) :
+	_it{std::move(it)}
+{}
+
+
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode QConcurrentTree<TKey, TValue, TContainer>::Snapshot::rootNode() const
+{
+	return SnapshotNode{_tree->rootNode()};
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::Snapshot::contains(QGenericTreeKeySpan<TKey> keys) const
+{
+	return _tree->contains(keys);
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+int QConcurrentTree<TKey, TValue, TContainer>::Snapshot::countElements(bool valueOnly) const
+{
+	return _tree->countElements(valueOnly);
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode QConcurrentTree<TKey, TValue, TContainer>::Snapshot::find(QGenericTreeKeySpan<TKey> keys) const
+{
+	return SnapshotNode{_tree->find(keys)};
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode QConcurrentTree<TKey, TValue, TContainer>::Snapshot::operator[](const TKey &key) const
+{
+	return SnapshotNode{(*_tree)[key]};
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode QConcurrentTree<TKey, TValue, TContainer>::Snapshot::operator[](QGenericTreeKeySpan<TKey> keys) const
+{
+	return SnapshotNode{(*_tree)[keys]};
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::const_iterator QConcurrentTree<TKey, TValue, TContainer>::Snapshot::begin() const
+{
+	return const_iterator{_tree->begin()};
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::const_iterator QConcurrentTree<TKey, TValue, TContainer>::Snapshot::end() const
+{
+	return const_iterator{_tree->end()};
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+QConcurrentTree<TKey, TValue, TContainer>::Snapshot::Snapshot(QSharedPointer<const Tree> tree) :
+	_tree{std::move(tree)}
+{}
+
+
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::Writer::contains(QGenericTreeKeySpan<TKey> keys) const
+{
+	return _tree.contains(keys);
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+int QConcurrentTree<TKey, TValue, TContainer>::Writer::countElements(bool valueOnly) const
+{
+	return _tree.countElements(valueOnly);
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::SnapshotNode QConcurrentTree<TKey, TValue, TContainer>::Writer::find(QGenericTreeKeySpan<TKey> keys) const
+{
+	return SnapshotNode{_tree.find(keys)};
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+void QConcurrentTree<TKey, TValue, TContainer>::Writer::setValue(QGenericTreeKeySpan<TKey> keys, TValue value)
+{
+	const auto node = _tree.copyPath(keys, true, _fresh);
+	const auto hadValue = node->value.has_value();
+	node->value = std::move(value);
+	node->valueChanged(hadValue, true);
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::Writer::clearValue(QGenericTreeKeySpan<TKey> keys)
+{
+	// look first, so nothing is copied if there is nothing to clear
+	const auto found = qAsConst(_tree).find(keys);
+	if (!found || !found.hasValue())
+		return false;
+
+	const auto node = _tree.copyPath(keys, false, _fresh);
+	node->value.reset();
+	node->valueChanged(true, false);
+	return true;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::Writer::remove(QGenericTreeKeySpan<TKey> keys)
+{
+	Q_ASSERT_X(!keys.isEmpty(), Q_FUNC_INFO, "The root node cannot be removed. Use clear instead.");
+	if (!_tree.contains(keys))
+		return false;
+
+	// the removed node is not orphaned, as published versions still use it
+	const auto parent = _tree.copyPath(QGenericTreeKeySpan<TKey>{keys.data(), keys.size() - 1}, false, _fresh);
+	const auto it = parent->children.find(keys[keys.size() - 1]);
+	const auto nodes = (*it)->subtreeNodes;
+	const auto values = (*it)->subtreeValues;
+	parent->children.erase(it);
+	parent->updateCounts(-nodes, -values);
+	return true;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+void QConcurrentTree<TKey, TValue, TContainer>::Writer::clear()
+{
+	_tree = Tree{};
+	_fresh.clear();
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+QConcurrentTree<TKey, TValue, TContainer>::Writer::Writer(Tree tree) :
+	_tree{std::move(tree)}
+{}
+
+
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+QConcurrentTree<TKey, TValue, TContainer>::QConcurrentTree() :
+	QConcurrentTree{Tree{}}
+{}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+QConcurrentTree<TKey, TValue, TContainer>::QConcurrentTree(Tree tree) :
+	_current{new Version{Snapshot{QSharedPointer<const Tree>{new Tree{std::move(tree)}}}}}
+{}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+QConcurrentTree<TKey, TValue, TContainer>::~QConcurrentTree()
+{
+	delete _current.load();
+	qDeleteAll(_retired);
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+typename QConcurrentTree<TKey, TValue, TContainer>::Snapshot QConcurrentTree<TKey, TValue, TContainer>::snapshot() const
+{
+	// the registration only counts if the epoch is still the same afterwards, otherwise a writer might
+	// have checked the counter already and it is repeated in the new epoch
+	forever {
+		const auto epoch = _epoch.load();
+		auto &readers = _readers[epoch & 1];
+		++readers;
+		if (_epoch.load() == epoch) {
+			auto snapshot = _current.load()->snapshot;
+			--readers;
+			return snapshot;
+		}
+		--readers;
+	}
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+template <typename TFunctor>
+void QConcurrentTree<TKey, TValue, TContainer>::update(TFunctor &&functor)
+{
+	QMutexLocker locker{&_writeLock};
+	Writer writer{_current.load()->snapshot._tree->share()};
+	functor(writer);
+	publish(std::move(writer._tree));
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+void QConcurrentTree<TKey, TValue, TContainer>::setValue(QGenericTreeKeySpan<TKey> keys, TValue value)
+{
+	update([&](Writer &writer) {
+		writer.setValue(keys, std::move(value));
+	});
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::clearValue(QGenericTreeKeySpan<TKey> keys)
+{
+	auto cleared = false;
+	update([&](Writer &writer) {
+		cleared = writer.clearValue(keys);
+	});
+	return cleared;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+bool QConcurrentTree<TKey, TValue, TContainer>::remove(QGenericTreeKeySpan<TKey> keys)
+{
+	auto removed = false;
+	update([&](Writer &writer) {
+		removed = writer.remove(keys);
+	});
+	return removed;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+void QConcurrentTree<TKey, TValue, TContainer>::clear()
+{
+	update([](Writer &writer) {
+		writer.clear();
+	});
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+void QConcurrentTree<TKey, TValue, TContainer>::publish(Tree tree)
+{
+	const auto retired = _current.exchange(new Version{Snapshot{QSharedPointer<const Tree>{new Tree{std::move(tree)}}}});
+	retired->retiredIn = _epoch.load();
+	_retired.append(retired);
+	reclaim();
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer>
+void QConcurrentTree<TKey, TValue, TContainer>::reclaim()
+{
+	// a new epoch only starts once the readers of the one before it are gone, so the versions retired in
+	// earlier epochs can only be copied by readers of the previous epoch. As soon as there are none, they
+	// are freed and a new epoch starts, which reuses their counter. This way every version is freed once
+	// the readers that might have seen it are done, no matter how many readers start in the meantime.
+	// The nodes themselves are freed by the snapshots, in whichever thread drops the last one.
+	const auto epoch = _epoch.load();
+	if (_readers[(epoch + 1) & 1].load() != 0)
+		return;
+
+	auto freed = 0;
+	for (; freed < _retired.size() && _retired[freed]->retiredIn != epoch; ++freed)
+		delete _retired[freed];
+	_retired.remove(0, freed);
+	if (!_retired.isEmpty())
+		_epoch.store(epoch + 1);
+}
+
+#endif // QCONCURRENTTREE_H
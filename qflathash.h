@@ -0,0 +1,714 @@
+#ifndef QFLATHASH_H
+#define QFLATHASH_H
+
+#include "qgenerictreebase.h"
+
+#include <new>
+#include <utility>
+
+#include <QtCore/QHash>
+#include <QtCore/QtAlgorithms>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// A child container for QGenericTreeBase that stores its entries in a single open addressing table.
+// Every slot has a control byte, which holds 7 bits of the hash of the key in the slot. Lookups
+// compare the control bytes of a whole group of 16 slots at once (using SSE2, where available) and only
+// touch the slots whose bits match, so most lookups need a single cache miss. The iteration order is
+// unspecified, just like for QHash. Unlike QHash, the table is not implicitly shared.
+// Lookups also accept keys of any other type that compares equal to TKey and hashes the same with qHash,
+// for example a QStringView or QLatin1String for QString keys, without constructing a TKey.
+template <typename TKey, typename TValue>
+class QFlatHash
+{
+	struct Entry {
+		TKey key;
+		TValue value;
+	};
+
+public:
+	template <bool TConst>
+	class iterator_base
+	{
+		friend class QFlatHash;
+		template <bool TOtherConst>
+		friend class iterator_base;
+
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = TValue;
+		using difference_type = qptrdiff;
+		using pointer = std::conditional_t<TConst, const TValue*, TValue*>;
+		using reference = std::conditional_t<TConst, const TValue&, TValue&>;
+
+		iterator_base() = default;
+		template <bool TOtherConst, typename = std::enable_if_t<TConst && !TOtherConst>>
+		iterator_base(const iterator_base<TOtherConst> &other);
+
+		bool operator==(const iterator_base &other) const;
+		bool operator!=(const iterator_base &other) const;
+		reference operator*() const;
+		pointer operator->() const;
+		iterator_base &operator++();
+		iterator_base operator++(int);
+		iterator_base &operator--();
+		iterator_base operator--(int);
+
+		const TKey &key() const;
+		reference value() const;
+
+	private:
+		const QFlatHash *_hash = nullptr;
+		int _index = 0;
+
+		iterator_base(const QFlatHash *hash, int index);
+	};
+
+	using iterator = iterator_base<false>;
+	using const_iterator = iterator_base<true>;
+	using key_type = TKey;
+	using mapped_type = TValue;
+	using size_type = int;
+	using is_transparent = void;
+
+	QFlatHash() = default;
+	QFlatHash(const QFlatHash &other);
+	QFlatHash &operator=(const QFlatHash &other);
+	QFlatHash(QFlatHash &&other) noexcept;
+	QFlatHash &operator=(QFlatHash &&other) noexcept;
+	~QFlatHash();
+
+	int size() const;
+	int count() const;
+	bool empty() const;
+	bool isEmpty() const;
+	int capacity() const;
+	void reserve(int size);
+
+	bool contains(const TKey &key) const;
+	TValue value(const TKey &key, const TValue &defaultValue = TValue{}) const;
+	TValue &first();
+	const TValue &first() const;
+	TValue &last();
+	const TValue &last() const;
+
+	iterator find(const TKey &key);
+	const_iterator find(const TKey &key) const;
+	const_iterator constFind(const TKey &key) const;
+	template <typename TLookupKey, typename = std::enable_if_t<QGenericTreeIsLookupKey<QFlatHash, TKey, TLookupKey>::value>>
+	bool contains(const TLookupKey &key) const;
+	template <typename TLookupKey, typename = std::enable_if_t<QGenericTreeIsLookupKey<QFlatHash, TKey, TLookupKey>::value>>
+	TValue value(const TLookupKey &key, const TValue &defaultValue = TValue{}) const;
+	template <typename TLookupKey, typename = std::enable_if_t<QGenericTreeIsLookupKey<QFlatHash, TKey, TLookupKey>::value>>
+	iterator find(const TLookupKey &key);
+	template <typename TLookupKey, typename = std::enable_if_t<QGenericTreeIsLookupKey<QFlatHash, TKey, TLookupKey>::value>>
+	const_iterator find(const TLookupKey &key) const;
+	template <typename TLookupKey, typename = std::enable_if_t<QGenericTreeIsLookupKey<QFlatHash, TKey, TLookupKey>::value>>
+	const_iterator constFind(const TLookupKey &key) const;
+	iterator insert(const TKey &key, const TValue &value);
+	TValue take(const TKey &key);
+	int remove(const TKey &key);
+	iterator erase(iterator it);
+	void clear();
+
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+	const_iterator cbegin() const;
+	const_iterator cend() const;
+	const_iterator constBegin() const;
+	const_iterator constEnd() const;
+
+private:
+	static constexpr int GroupSize = 16;
+	// the largest power of two that fits into an int, as capacities always are powers of two
+	static constexpr int MaxCapacity = 1 << 30;
+	static constexpr qint8 Empty = -128;
+	static constexpr qint8 Deleted = -2;
+
+	// a group of GroupSize control bytes, the match functions return one bit per matching slot
+	struct Group {
+#ifdef __SSE2__
+		__m128i ctrl;
+
+		inline explicit Group(const qint8 *pos) :
+			ctrl{_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))}
+		{}
+
+		inline quint32 match(qint8 h2) const {
+			return static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+		}
+
+		inline quint32 matchFree() const {
+			return static_cast<quint32>(_mm_movemask_epi8(ctrl));
+		}
+#else
+		const qint8 *ctrl;
+
+		inline explicit Group(const qint8 *pos) :
+			ctrl{pos}
+		{}
+
+		inline quint32 match(qint8 h2) const {
+			quint32 mask = 0;
+			for (auto i = 0; i < GroupSize; ++i)
+				mask |= static_cast<quint32>(ctrl[i] == h2) << i;
+			return mask;
+		}
+
+		inline quint32 matchFree() const {
+			quint32 mask = 0;
+			for (auto i = 0; i < GroupSize; ++i)
+				mask |= static_cast<quint32>(ctrl[i] < 0) << i;
+			return mask;
+		}
+#endif
+
+		inline quint32 matchEmpty() const {
+			return match(Empty);
+		}
+	};
+
+	qint8 *_ctrl = nullptr;
+	Entry *_slots = nullptr;
+	int _capacity = 0;
+	int _size = 0;
+	// the number of empty slots that may still be filled before the table has to grow
+	int _growthLeft = 0;
+
+	template <typename TLookupKey>
+	static quint64 hashOf(const TLookupKey &key);
+	static constexpr int maxLoad(int capacity);
+
+	template <typename TLookupKey>
+	int findIndex(const TLookupKey &key) const;
+	int findFreeIndex(quint64 hash) const;
+	int nextIndex(int index) const;
+	int prevIndex(int index) const;
+	void eraseIndex(int index);
+	void rehash(int capacity);
+	void release();
+};
+
+template <typename TKey, typename TValue, typename... TPolicies>
+using QFlatUnorderedTree = QGenericTreeBase<TKey, TValue, QFlatHash, TPolicies...>;
+
+// GENERIC IMPLEMENTATION
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+template <bool TOtherConst, typename>
+QFlatHash<TKey, TValue>::iterator_base<TConst>::iterator_base(const iterator_base<TOtherConst> &other) :
+	_hash{other._hash},
+	_index{other._index}
+{}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+bool QFlatHash<TKey, TValue>::iterator_base<TConst>::operator==(const iterator_base &other) const
+{
+	return _index == other._index;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+bool QFlatHash<TKey, TValue>::iterator_base<TConst>::operator!=(const iterator_base &other) const
+{
+	return _index != other._index;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatHash<TKey, TValue>::template iterator_base<TConst>::reference QFlatHash<TKey, TValue>::iterator_base<TConst>::operator*() const
+{
+	return _hash->_slots[_index].value;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatHash<TKey, TValue>::template iterator_base<TConst>::pointer QFlatHash<TKey, TValue>::iterator_base<TConst>::operator->() const
+{
+	return &_hash->_slots[_index].value;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatHash<TKey, TValue>::template iterator_base<TConst> &QFlatHash<TKey, TValue>::iterator_base<TConst>::operator++()
+{
+	_index = _hash->nextIndex(_index + 1);
+	return *this;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatHash<TKey, TValue>::template iterator_base<TConst> QFlatHash<TKey, TValue>::iterator_base<TConst>::operator++(int)
+{
+	auto copy = *this;
+	operator++();
+	return copy;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatHash<TKey, TValue>::template iterator_base<TConst> &QFlatHash<TKey, TValue>::iterator_base<TConst>::operator--()
+{
+	_index = _hash->prevIndex(_index - 1);
+	return *this;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatHash<TKey, TValue>::template iterator_base<TConst> QFlatHash<TKey, TValue>::iterator_base<TConst>::operator--(int)
+{
+	auto copy = *this;
+	operator--();
+	return copy;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+const TKey &QFlatHash<TKey, TValue>::iterator_base<TConst>::key() const
+{
+	return _hash->_slots[_index].key;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatHash<TKey, TValue>::template iterator_base<TConst>::reference QFlatHash<TKey, TValue>::iterator_base<TConst>::value() const
+{
+	return _hash->_slots[_index].value;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+QFlatHash<TKey, TValue>::iterator_base<TConst>::iterator_base(const QFlatHash *hash, int index) :
+	_hash{hash},
+	_index{index}
+{}
+
+
+
+template <typename TKey, typename TValue>
+QFlatHash<TKey, TValue>::QFlatHash(const QFlatHash &other)
+{
+	operator=(other);
+}
+
+template <typename TKey, typename TValue>
+QFlatHash<TKey, TValue> &QFlatHash<TKey, TValue>::operator=(const QFlatHash &other)
+{
+	if (this == &other)
+		return *this;
+
+	release();
+	if (other._size > 0) {
+		// copy the tombstones as well, so all keys keep their probe positions
+		rehash(other._capacity);
+		std::copy(other._ctrl, other._ctrl + _capacity, _ctrl);
+		for (auto index = nextIndex(0); index < _capacity; index = nextIndex(index + 1))
+			new (_slots + index) Entry{other._slots[index]};
+		_size = other._size;
+		_growthLeft = other._growthLeft;
+	}
+	return *this;
+}
+
+template <typename TKey, typename TValue>
+QFlatHash<TKey, TValue>::QFlatHash(QFlatHash &&other) noexcept :
+	_ctrl{std::exchange(other._ctrl, nullptr)},
+	_slots{std::exchange(other._slots, nullptr)},
+	_capacity{std::exchange(other._capacity, 0)},
+	_size{std::exchange(other._size, 0)},
+	_growthLeft{std::exchange(other._growthLeft, 0)}
+{}
+
+template <typename TKey, typename TValue>
+QFlatHash<TKey, TValue> &QFlatHash<TKey, TValue>::operator=(QFlatHash &&other) noexcept
+{
+	if (this != &other) {
+		release();
+		_ctrl = std::exchange(other._ctrl, nullptr);
+		_slots = std::exchange(other._slots, nullptr);
+		_capacity = std::exchange(other._capacity, 0);
+		_size = std::exchange(other._size, 0);
+		_growthLeft = std::exchange(other._growthLeft, 0);
+	}
+	return *this;
+}
+
+template <typename TKey, typename TValue>
+QFlatHash<TKey, TValue>::~QFlatHash()
+{
+	release();
+}
+
+template <typename TKey, typename TValue>
+int QFlatHash<TKey, TValue>::size() const
+{
+	return _size;
+}
+
+template <typename TKey, typename TValue>
+int QFlatHash<TKey, TValue>::count() const
+{
+	return _size;
+}
+
+template <typename TKey, typename TValue>
+bool QFlatHash<TKey, TValue>::empty() const
+{
+	return _size == 0;
+}
+
+template <typename TKey, typename TValue>
+bool QFlatHash<TKey, TValue>::isEmpty() const
+{
+	return _size == 0;
+}
+
+template <typename TKey, typename TValue>
+int QFlatHash<TKey, TValue>::capacity() const
+{
+	return _capacity;
+}
+
+template <typename TKey, typename TValue>
+void QFlatHash<TKey, TValue>::reserve(int size)
+{
+	// reserving is only a hint, so larger sizes are clamped instead of doubling the capacity past the int range
+	auto capacity = GroupSize;
+	while (capacity < MaxCapacity && maxLoad(capacity) < size)
+		capacity *= 2;
+	if (capacity > _capacity)
+		rehash(capacity);
+}
+
+template <typename TKey, typename TValue>
+bool QFlatHash<TKey, TValue>::contains(const TKey &key) const
+{
+	return findIndex(key) != _capacity;
+}
+
+template <typename TKey, typename TValue>
+TValue QFlatHash<TKey, TValue>::value(const TKey &key, const TValue &defaultValue) const
+{
+	const auto index = findIndex(key);
+	return index != _capacity ? _slots[index].value : defaultValue;
+}
+
+template <typename TKey, typename TValue>
+TValue &QFlatHash<TKey, TValue>::first()
+{
+	return *begin();
+}
+
+template <typename TKey, typename TValue>
+const TValue &QFlatHash<TKey, TValue>::first() const
+{
+	return *begin();
+}
+
+template <typename TKey, typename TValue>
+TValue &QFlatHash<TKey, TValue>::last()
+{
+	return *--end();
+}
+
+template <typename TKey, typename TValue>
+const TValue &QFlatHash<TKey, TValue>::last() const
+{
+	return *--end();
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::iterator QFlatHash<TKey, TValue>::find(const TKey &key)
+{
+	return iterator{this, findIndex(key)};
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::const_iterator QFlatHash<TKey, TValue>::find(const TKey &key) const
+{
+	return const_iterator{this, findIndex(key)};
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::const_iterator QFlatHash<TKey, TValue>::constFind(const TKey &key) const
+{
+	return const_iterator{this, findIndex(key)};
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey, typename>
+bool QFlatHash<TKey, TValue>::contains(const TLookupKey &key) const
+{
+	return findIndex(key) != _capacity;
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey, typename>
+TValue QFlatHash<TKey, TValue>::value(const TLookupKey &key, const TValue &defaultValue) const
+{
+	const auto index = findIndex(key);
+	return index != _capacity ? _slots[index].value : defaultValue;
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey, typename>
+typename QFlatHash<TKey, TValue>::iterator QFlatHash<TKey, TValue>::find(const TLookupKey &key)
+{
+	return iterator{this, findIndex(key)};
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey, typename>
+typename QFlatHash<TKey, TValue>::const_iterator QFlatHash<TKey, TValue>::find(const TLookupKey &key) const
+{
+	return const_iterator{this, findIndex(key)};
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey, typename>
+typename QFlatHash<TKey, TValue>::const_iterator QFlatHash<TKey, TValue>::constFind(const TLookupKey &key) const
+{
+	return const_iterator{this, findIndex(key)};
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::iterator QFlatHash<TKey, TValue>::insert(const TKey &key, const TValue &value)
+{
+	if (const auto index = findIndex(key); index != _capacity) {
+		_slots[index].value = value;
+		return iterator{this, index};
+	}
+
+	if (_growthLeft == 0) {
+		// drop the tombstones if that frees enough slots, grow otherwise
+		if (_capacity > 0 && _size * 2 < maxLoad(_capacity))
+			rehash(_capacity);
+		else {
+			Q_ASSERT_X(_capacity < MaxCapacity, Q_FUNC_INFO, "The table cannot grow any further");
+			rehash(_capacity > 0 ? _capacity * 2 : GroupSize);
+		}
+	}
+
+	const auto hash = hashOf(key);
+	const auto index = findFreeIndex(hash);
+	if (_ctrl[index] == Empty)
+		--_growthLeft;
+	new (_slots + index) Entry{key, value};
+	_ctrl[index] = static_cast<qint8>(hash & 0x7F);
+	++_size;
+	return iterator{this, index};
+}
+
+template <typename TKey, typename TValue>
+TValue QFlatHash<TKey, TValue>::take(const TKey &key)
+{
+	const auto index = findIndex(key);
+	if (index == _capacity)
+		return TValue{};
+	auto value = std::move(_slots[index].value);
+	eraseIndex(index);
+	return value;
+}
+
+template <typename TKey, typename TValue>
+int QFlatHash<TKey, TValue>::remove(const TKey &key)
+{
+	const auto index = findIndex(key);
+	if (index == _capacity)
+		return 0;
+	eraseIndex(index);
+	return 1;
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::iterator QFlatHash<TKey, TValue>::erase(iterator it)
+{
+	eraseIndex(it._index);
+	return iterator{this, nextIndex(it._index + 1)};
+}
+
+template <typename TKey, typename TValue>
+void QFlatHash<TKey, TValue>::clear()
+{
+	release();
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::iterator QFlatHash<TKey, TValue>::begin()
+{
+	return iterator{this, nextIndex(0)};
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::iterator QFlatHash<TKey, TValue>::end()
+{
+	return iterator{this, _capacity};
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::const_iterator QFlatHash<TKey, TValue>::begin() const
+{
+	return const_iterator{this, nextIndex(0)};
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::const_iterator QFlatHash<TKey, TValue>::end() const
+{
+	return const_iterator{this, _capacity};
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::const_iterator QFlatHash<TKey, TValue>::cbegin() const
+{
+	return const_iterator{this, nextIndex(0)};
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::const_iterator QFlatHash<TKey, TValue>::cend() const
+{
+	return const_iterator{this, _capacity};
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::const_iterator QFlatHash<TKey, TValue>::constBegin() const
+{
+	return const_iterator{this, nextIndex(0)};
+}
+
+template <typename TKey, typename TValue>
+typename QFlatHash<TKey, TValue>::const_iterator QFlatHash<TKey, TValue>::constEnd() const
+{
+	return const_iterator{this, _capacity};
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey>
+quint64 QFlatHash<TKey, TValue>::hashOf(const TLookupKey &key)
+{
+	// qHash is the identity for integers, so spread the bits before splitting them
+	const auto hash = static_cast<quint64>(qHash(key)) * Q_UINT64_C(0x9E3779B97F4A7C15);
+	return hash ^ (hash >> 32);
+}
+
+template <typename TKey, typename TValue>
+constexpr int QFlatHash<TKey, TValue>::maxLoad(int capacity)
+{
+	return capacity - capacity / 8;
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey>
+int QFlatHash<TKey, TValue>::findIndex(const TLookupKey &key) const
+{
+	if (_size == 0)
+		return _capacity;
+
+	const auto hash = hashOf(key);
+	const auto h2 = static_cast<qint8>(hash & 0x7F);
+	const auto groupMask = _capacity / GroupSize - 1;
+	auto group = static_cast<int>(hash >> 7) & groupMask;
+	// triangular probing visits every group exactly once, as the group count is a power of two
+	for (auto step = 1; ; ++step) {
+		const auto base = group * GroupSize;
+		const Group ctrl{_ctrl + base};
+		for (auto mask = ctrl.match(h2); mask != 0; mask &= mask - 1) {
+			const auto index = base + qCountTrailingZeroBits(mask);
+			if (_slots[index].key == key)
+				return index;
+		}
+		if (ctrl.matchEmpty() != 0 || step > groupMask)
+			return _capacity;
+		group = (group + step) & groupMask;
+	}
+}
+
+template <typename TKey, typename TValue>
+int QFlatHash<TKey, TValue>::findFreeIndex(quint64 hash) const
+{
+	const auto groupMask = _capacity / GroupSize - 1;
+	auto group = static_cast<int>(hash >> 7) & groupMask;
+	for (auto step = 1; ; ++step) {
+		const auto base = group * GroupSize;
+		if (const auto mask = Group{_ctrl + base}.matchFree(); mask != 0)
+			return base + qCountTrailingZeroBits(mask);
+		group = (group + step) & groupMask;
+	}
+}
+
+template <typename TKey, typename TValue>
+int QFlatHash<TKey, TValue>::nextIndex(int index) const
+{
+	while (index < _capacity && _ctrl[index] < 0)
+		++index;
+	return index;
+}
+
+template <typename TKey, typename TValue>
+int QFlatHash<TKey, TValue>::prevIndex(int index) const
+{
+	while (index >= 0 && _ctrl[index] < 0)
+		--index;
+	return index;
+}
+
+template <typename TKey, typename TValue>
+void QFlatHash<TKey, TValue>::eraseIndex(int index)
+{
+	_slots[index].~Entry();
+	--_size;
+	// probes only continue past groups without empty slots, so a group that still has one can reuse the slot
+	const auto base = index - index % GroupSize;
+	if (Group{_ctrl + base}.matchEmpty() != 0) {
+		_ctrl[index] = Empty;
+		++_growthLeft;
+	} else
+		_ctrl[index] = Deleted;
+}
+
+template <typename TKey, typename TValue>
+void QFlatHash<TKey, TValue>::rehash(int capacity)
+{
+	auto oldCtrl = std::exchange(_ctrl, new qint8[capacity]);
+	auto oldSlots = std::exchange(_slots, static_cast<Entry*>(::operator new(capacity * sizeof(Entry), std::align_val_t{alignof(Entry)})));
+	const auto oldCapacity = std::exchange(_capacity, capacity);
+	std::fill(_ctrl, _ctrl + capacity, Empty);
+	_growthLeft = maxLoad(capacity) - _size;
+
+	for (auto index = 0; index < oldCapacity; ++index) {
+		if (oldCtrl[index] < 0)
+			continue;
+		auto &entry = oldSlots[index];
+		const auto hash = hashOf(entry.key);
+		const auto newIndex = findFreeIndex(hash);
+		new (_slots + newIndex) Entry{std::move(entry)};
+		_ctrl[newIndex] = static_cast<qint8>(hash & 0x7F);
+		entry.~Entry();
+	}
+
+	delete[] oldCtrl;
+	if (oldSlots)
+		::operator delete(oldSlots, std::align_val_t{alignof(Entry)});
+}
+
+template <typename TKey, typename TValue>
+void QFlatHash<TKey, TValue>::release()
+{
+	for (auto index = nextIndex(0); index < _capacity; index = nextIndex(index + 1))
+		_slots[index].~Entry();
+	delete[] _ctrl;
+	if (_slots)
+		::operator delete(_slots, std::align_val_t{alignof(Entry)});
+	_ctrl = nullptr;
+	_slots = nullptr;
+	_capacity = 0;
+	_size = 0;
+	_growthLeft = 0;
+}
+
+#endif // QFLATHASH_H
@@ -0,0 +1,484 @@
+#ifndef QFLATMAP_H
+#define QFLATMAP_H
+
+#include "qgenerictreebase.h"
+
+#include <algorithm>
+
+#include <QtCore/QVector>
+
+// A child container for QGenericTreeBase that keeps keys and values in two sorted, contiguous vectors.
+// Lookups are binary searches over the keys only and iteration walks plain arrays, in the same order
+// as a QMap. Inserting and removing children has to move all following entries, so it is best suited
+// for trees that are read much more often than they are modified.
+// Lookups also accept keys of any other type that can be compared with TKey in both directions, for
+// example a QStringView or QLatin1String for QString keys, without constructing a TKey.
+template <typename TKey, typename TValue>
+class QFlatMap
+{
+public:
+	template <bool TConst>
+	class iterator_base
+	{
+		friend class QFlatMap;
+		template <bool TOtherConst>
+		friend class iterator_base;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = TValue;
+		using difference_type = qptrdiff;
+		using pointer = std::conditional_t<TConst, const TValue*, TValue*>;
+		using reference = std::conditional_t<TConst, const TValue&, TValue&>;
+
+		iterator_base() = default;
+		template <bool TOtherConst, typename = std::enable_if_t<TConst && !TOtherConst>>
+		iterator_base(const iterator_base<TOtherConst> &other);
+
+		bool operator==(const iterator_base &other) const;
+		bool operator!=(const iterator_base &other) const;
+		reference operator*() const;
+		pointer operator->() const;
+		iterator_base &operator++();
+		iterator_base operator++(int);
+		iterator_base &operator--();
+		iterator_base operator--(int);
+
+		const TKey &key() const;
+		reference value() const;
+
+	private:
+		const TKey *_key = nullptr;
+		pointer _value = nullptr;
+
+		iterator_base(const TKey *key, pointer value);
+	};
+
+	using iterator = iterator_base<false>;
+	using const_iterator = iterator_base<true>;
+	using key_type = TKey;
+	using mapped_type = TValue;
+	using size_type = int;
+	using is_transparent = void;
+
+	int size() const;
+	int count() const;
+	bool empty() const;
+	bool isEmpty() const;
+	void reserve(int size);
+
+	bool contains(const TKey &key) const;
+	TValue value(const TKey &key, const TValue &defaultValue = TValue{}) const;
+	TValue &first();
+	const TValue &first() const;
+	TValue &last();
+	const TValue &last() const;
+
+	iterator find(const TKey &key);
+	const_iterator find(const TKey &key) const;
+	const_iterator constFind(const TKey &key) const;
+	template <typename TLookupKey, typename = std::enable_if_t<QGenericTreeIsLookupKey<QFlatMap, TKey, TLookupKey>::value>>
+	bool contains(const TLookupKey &key) const;
+	template <typename TLookupKey, typename = std::enable_if_t<QGenericTreeIsLookupKey<QFlatMap, TKey, TLookupKey>::value>>
+	TValue value(const TLookupKey &key, const TValue &defaultValue = TValue{}) const;
+	template <typename TLookupKey, typename = std::enable_if_t<QGenericTreeIsLookupKey<QFlatMap, TKey, TLookupKey>::value>>
+	iterator find(const TLookupKey &key);
+	template <typename TLookupKey, typename = std::enable_if_t<QGenericTreeIsLookupKey<QFlatMap, TKey, TLookupKey>::value>>
+	const_iterator find(const TLookupKey &key) const;
+	template <typename TLookupKey, typename = std::enable_if_t<QGenericTreeIsLookupKey<QFlatMap, TKey, TLookupKey>::value>>
+	const_iterator constFind(const TLookupKey &key) const;
+	iterator insert(const TKey &key, const TValue &value);
+	iterator insert(const_iterator pos, const TKey &key, const TValue &value);
+	TValue take(const TKey &key);
+	int remove(const TKey &key);
+	iterator erase(iterator it);
+	void clear();
+
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+	const_iterator cbegin() const;
+	const_iterator cend() const;
+	const_iterator constBegin() const;
+	const_iterator constEnd() const;
+
+private:
+	QVector<TKey> _keys;
+	QVector<TValue> _values;
+
+	template <typename TLookupKey>
+	int lowerBound(const TLookupKey &key) const;
+	template <typename TLookupKey>
+	int indexOf(const TLookupKey &key) const;
+	iterator iteratorAt(int index);
+	const_iterator iteratorAt(int index) const;
+};
+
+template <typename TKey, typename TValue, typename... TPolicies>
+using QFlatOrderedTree = QGenericTreeBase<TKey, TValue, QFlatMap, TPolicies...>;
+
+// GENERIC IMPLEMENTATION
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+template <bool TOtherConst, typename>
+QFlatMap<TKey, TValue>::iterator_base<TConst>::iterator_base(const iterator_base<TOtherConst> &other) :
+	_key{other._key},
+	_value{other._value}
+{}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+bool QFlatMap<TKey, TValue>::iterator_base<TConst>::operator==(const iterator_base &other) const
+{
+	return _key == other._key;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+bool QFlatMap<TKey, TValue>::iterator_base<TConst>::operator!=(const iterator_base &other) const
+{
+	return _key != other._key;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatMap<TKey, TValue>::template iterator_base<TConst>::reference QFlatMap<TKey, TValue>::iterator_base<TConst>::operator*() const
+{
+	return *_value;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatMap<TKey, TValue>::template iterator_base<TConst>::pointer QFlatMap<TKey, TValue>::iterator_base<TConst>::operator->() const
+{
+	return _value;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatMap<TKey, TValue>::template iterator_base<TConst> &QFlatMap<TKey, TValue>::iterator_base<TConst>::operator++()
+{
+	++_key;
+	++_value;
+	return *this;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatMap<TKey, TValue>::template iterator_base<TConst> QFlatMap<TKey, TValue>::iterator_base<TConst>::operator++(int)
+{
+	auto copy = *this;
+	operator++();
+	return copy;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatMap<TKey, TValue>::template iterator_base<TConst> &QFlatMap<TKey, TValue>::iterator_base<TConst>::operator--()
+{
+	--_key;
+	--_value;
+	return *this;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatMap<TKey, TValue>::template iterator_base<TConst> QFlatMap<TKey, TValue>::iterator_base<TConst>::operator--(int)
+{
+	auto copy = *this;
+	operator--();
+	return copy;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+const TKey &QFlatMap<TKey, TValue>::iterator_base<TConst>::key() const
+{
+	return *_key;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+typename QFlatMap<TKey, TValue>::template iterator_base<TConst>::reference QFlatMap<TKey, TValue>::iterator_base<TConst>::value() const
+{
+	return *_value;
+}
+
+template <typename TKey, typename TValue>
+template <bool TConst>
+QFlatMap<TKey, TValue>::iterator_base<TConst>::iterator_base(const TKey *key, pointer value) :
+	_key{key},
+	_value{value}
+{}
+
+
+
+template <typename TKey, typename TValue>
+int QFlatMap<TKey, TValue>::size() const
+{
+	return _keys.size();
+}
+
+template <typename TKey, typename TValue>
+int QFlatMap<TKey, TValue>::count() const
+{
+	return _keys.size();
+}
+
+template <typename TKey, typename TValue>
+bool QFlatMap<TKey, TValue>::empty() const
+{
+	return _keys.isEmpty();
+}
+
+template <typename TKey, typename TValue>
+bool QFlatMap<TKey, TValue>::isEmpty() const
+{
+	return _keys.isEmpty();
+}
+
+template <typename TKey, typename TValue>
+void QFlatMap<TKey, TValue>::reserve(int size)
+{
+	_keys.reserve(size);
+	_values.reserve(size);
+}
+
+template <typename TKey, typename TValue>
+bool QFlatMap<TKey, TValue>::contains(const TKey &key) const
+{
+	return indexOf(key) != -1;
+}
+
+template <typename TKey, typename TValue>
+TValue QFlatMap<TKey, TValue>::value(const TKey &key, const TValue &defaultValue) const
+{
+	const auto index = indexOf(key);
+	return index != -1 ? _values[index] : defaultValue;
+}
+
+template <typename TKey, typename TValue>
+TValue &QFlatMap<TKey, TValue>::first()
+{
+	return _values.first();
+}
+
+template <typename TKey, typename TValue>
+const TValue &QFlatMap<TKey, TValue>::first() const
+{
+	return _values.first();
+}
+
+template <typename TKey, typename TValue>
+TValue &QFlatMap<TKey, TValue>::last()
+{
+	return _values.last();
+}
+
+template <typename TKey, typename TValue>
+const TValue &QFlatMap<TKey, TValue>::last() const
+{
+	return _values.last();
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::iterator QFlatMap<TKey, TValue>::find(const TKey &key)
+{
+	const auto index = indexOf(key);
+	return index != -1 ? iteratorAt(index) : end();
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::const_iterator QFlatMap<TKey, TValue>::find(const TKey &key) const
+{
+	const auto index = indexOf(key);
+	return index != -1 ? iteratorAt(index) : cend();
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::const_iterator QFlatMap<TKey, TValue>::constFind(const TKey &key) const
+{
+	return find(key);
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey, typename>
+bool QFlatMap<TKey, TValue>::contains(const TLookupKey &key) const
+{
+	return indexOf(key) != -1;
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey, typename>
+TValue QFlatMap<TKey, TValue>::value(const TLookupKey &key, const TValue &defaultValue) const
+{
+	const auto index = indexOf(key);
+	return index != -1 ? _values[index] : defaultValue;
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey, typename>
+typename QFlatMap<TKey, TValue>::iterator QFlatMap<TKey, TValue>::find(const TLookupKey &key)
+{
+	const auto index = indexOf(key);
+	return index != -1 ? iteratorAt(index) : end();
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey, typename>
+typename QFlatMap<TKey, TValue>::const_iterator QFlatMap<TKey, TValue>::find(const TLookupKey &key) const
+{
+	const auto index = indexOf(key);
+	return index != -1 ? iteratorAt(index) : cend();
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey, typename>
+typename QFlatMap<TKey, TValue>::const_iterator QFlatMap<TKey, TValue>::constFind(const TLookupKey &key) const
+{
+	return find(key);
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::iterator QFlatMap<TKey, TValue>::insert(const TKey &key, const TValue &value)
+{
+	const auto index = lowerBound(key);
+	if (index < _keys.size() && !(key < _keys[index]))
+		_values[index] = value;
+	else {
+		_keys.insert(index, key);
+		_values.insert(index, value);
+	}
+	return iteratorAt(index);
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::iterator QFlatMap<TKey, TValue>::insert(const_iterator pos, const TKey &key, const TValue &value)
+{
+	// a correct hint skips the binary search, which makes appending sorted keys linear
+	const auto index = static_cast<int>(pos._key - _keys.constData());
+	if ((index == 0 || _keys[index - 1] < key) && (index == _keys.size() || key < _keys[index])) {
+		_keys.insert(index, key);
+		_values.insert(index, value);
+		return iteratorAt(index);
+	} else
+		return insert(key, value);
+}
+
+template <typename TKey, typename TValue>
+TValue QFlatMap<TKey, TValue>::take(const TKey &key)
+{
+	const auto index = indexOf(key);
+	if (index == -1)
+		return TValue{};
+	_keys.removeAt(index);
+	return _values.takeAt(index);
+}
+
+template <typename TKey, typename TValue>
+int QFlatMap<TKey, TValue>::remove(const TKey &key)
+{
+	const auto index = indexOf(key);
+	if (index == -1)
+		return 0;
+	_keys.removeAt(index);
+	_values.removeAt(index);
+	return 1;
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::iterator QFlatMap<TKey, TValue>::erase(iterator it)
+{
+	const auto index = static_cast<int>(it._key - _keys.constData());
+	_keys.removeAt(index);
+	_values.removeAt(index);
+	return iteratorAt(index);
+}
+
+template <typename TKey, typename TValue>
+void QFlatMap<TKey, TValue>::clear()
+{
+	_keys.clear();
+	_values.clear();
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::iterator QFlatMap<TKey, TValue>::begin()
+{
+	return iteratorAt(0);
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::iterator QFlatMap<TKey, TValue>::end()
+{
+	return iteratorAt(_keys.size());
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::const_iterator QFlatMap<TKey, TValue>::begin() const
+{
+	return iteratorAt(0);
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::const_iterator QFlatMap<TKey, TValue>::end() const
+{
+	return iteratorAt(_keys.size());
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::const_iterator QFlatMap<TKey, TValue>::cbegin() const
+{
+	return iteratorAt(0);
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::const_iterator QFlatMap<TKey, TValue>::cend() const
+{
+	return iteratorAt(_keys.size());
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::const_iterator QFlatMap<TKey, TValue>::constBegin() const
+{
+	return iteratorAt(0);
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::const_iterator QFlatMap<TKey, TValue>::constEnd() const
+{
+	return iteratorAt(_keys.size());
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey>
+int QFlatMap<TKey, TValue>::lowerBound(const TLookupKey &key) const
+{
+	const auto begin = _keys.constData();
+	return static_cast<int>(std::lower_bound(begin, begin + _keys.size(), key) - begin);
+}
+
+template <typename TKey, typename TValue>
+template <typename TLookupKey>
+int QFlatMap<TKey, TValue>::indexOf(const TLookupKey &key) const
+{
+	const auto index = lowerBound(key);
+	return index < _keys.size() && !(key < _keys[index]) ? index : -1;
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::iterator QFlatMap<TKey, TValue>::iteratorAt(int index)
+{
+	// data() detaches the values, the keys are never modified through an iterator
+	return iterator{_keys.constData() + index, _values.data() + index};
+}
+
+template <typename TKey, typename TValue>
+typename QFlatMap<TKey, TValue>::const_iterator QFlatMap<TKey, TValue>::iteratorAt(int index) const
+{
+	return const_iterator{_keys.constData() + index, _values.constData() + index};
+}
+
+#endif // QFLATMAP_H
@@ -0,0 +1,758 @@
+#ifndef QFROZENTREE_H
+#define QFROZENTREE_H
+
+#include "qgenerictreebase.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QVarLengthArray>
+
+// A read-only view of a tree that was written to a file with freeze(). The file is memory mapped when
+// opened, so nothing is parsed or allocated up front and only the pages that are used are ever read.
+// The file holds a header, all nodes as an array in preorder, the sorted keys of the children of every
+// node as one contiguous range, and the values. All links are indices, so the file can be mapped
+// anywhere. The keys and values are copied bytewise and must be trivially copyable, and the file can
+// only be read on machines with the same byte order. Nodes and iterators are only valid as long as the
+// frozen tree they came from is open.
+template <typename TKey, typename TValue>
+class QFrozenTree
+{
+	static_assert(std::is_trivially_copyable_v<TKey>, "QFrozenTree requires a trivially copyable key type");
+	static_assert(std::is_trivially_copyable_v<TValue>, "QFrozenTree requires a trivially copyable value type");
+
+	struct Data;
+
+public:
+	class ConstNode
+	{
+	public:
+		ConstNode() = default;
+
+		explicit operator bool() const;
+		bool operator!() const;
+		bool operator==(const ConstNode &other) const;
+		bool operator!=(const ConstNode &other) const;
+
+		// value access functions
+		bool hasValue() const;
+		TValue value(const TValue &defaultValue = TValue{}) const;
+		// value access operators
+		const TValue &operator*() const;
+		const TValue *operator->() const;
+
+		// child access
+		bool containsChild(const TKey &key) const;
+		int childCount() const;
+		bool hasChildren() const;
+		QList<ConstNode> children() const;
+		ConstNode child(const TKey &key) const;
+		// child access operators
+		ConstNode operator[](const TKey &key) const;
+
+		// tree access
+		int depth() const;
+		QList<TKey> key() const;
+		TKey subKey() const;
+		ConstNode parent() const;
+		ConstNode findChild(QGenericTreeKeySpan<TKey> keys) const;
+		int subtreeSize(bool valueOnly = false) const;
+
+	private:
+		friend class QFrozenTree;
+
+		const Data *d = nullptr;
+		quint32 _index = 0;
+
+		inline ConstNode(const Data *data, quint32 index);
+	};
+
+	// iterates over all nodes but the root in preorder, which is simply the order of the node array
+	class const_iterator
+	{
+		friend class QFrozenTree;
+	public:
+		using value_type = const TValue;
+		using difference_type = int;
+		using pointer = value_type*;
+		using reference = value_type&;
+		using iterator_category = std::bidirectional_iterator_tag;
+
+		const_iterator() = default;
+
+		bool operator==(const const_iterator &other) const;
+		bool operator!=(const const_iterator &other) const;
+		reference operator*() const;
+		pointer operator->() const;
+		const_iterator &operator++();
+		const_iterator operator++(int);
+		const_iterator &operator--();
+		const_iterator operator--(int);
+
+		explicit operator bool() const;
+		bool operator!() const;
+		QList<TKey> key() const;
+		TKey subKey() const;
+		ConstNode node() const;
+
+	private:
+		const Data *d = nullptr;
+		quint32 _index = 0;
+
+		inline const_iterator(const Data *data, quint32 index);
+	};
+
+	using iterator = const_iterator;
+
+	QFrozenTree();
+	explicit QFrozenTree(const QString &fileName);
+	QFrozenTree(QFrozenTree &&other) noexcept = default;
+	QFrozenTree &operator=(QFrozenTree &&other) noexcept = default;
+	~QFrozenTree() = default;
+	Q_DISABLE_COPY(QFrozenTree)
+
+	// writes the tree to the file, with the children of every node sorted by their keys
+	template <template<class, class> class TContainer, typename... TPolicies>
+	static bool freeze(const QGenericTreeBase<TKey, TValue, TContainer, TPolicies...> &tree, const QString &fileName);
+
+	bool open(const QString &fileName);
+	bool isOpen() const;
+	void close();
+
+	ConstNode rootNode() const;
+
+	bool contains(const TKey &key) const;
+	bool contains(QGenericTreeKeySpan<TKey> key) const;
+	int countElements(bool valueOnly = false) const;
+	ConstNode find(QGenericTreeKeySpan<TKey> keys) const;
+	ConstNode operator[](const TKey &key) const;
+	ConstNode operator[](QGenericTreeKeySpan<TKey> key) const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+private:
+	static constexpr quint32 Version = 1;
+	static constexpr quint32 ByteOrderMark = 0x01020304;
+	static constexpr quint32 NoIndex = std::numeric_limits<quint32>::max();
+
+	struct Header {
+		char magic[8];
+		quint32 version;
+		quint32 byteOrder;
+		quint32 keySize;
+		quint32 valueSize;
+		quint32 nodeCount;
+		quint32 reserved;
+		quint64 nodeOffset;
+		quint64 slotOffset;
+		quint64 keyOffset;
+		quint64 valueOffset;
+	};
+
+	// the children of a node are the slots firstSlot to firstSlot + childCount, sorted by key
+	struct NodeRecord {
+		quint32 parent;
+		quint32 slot; // the slot of this node in the children of its parent
+		quint32 firstSlot;
+		quint32 childCount;
+		quint32 subtreeNodes;
+		quint32 subtreeValues;
+		quint32 depth;
+		quint32 hasValue;
+	};
+
+	struct Data {
+		QFile file;
+		const NodeRecord *nodes = nullptr;
+		const quint32 *slotNodes = nullptr;
+		const TKey *keys = nullptr;
+		const TValue *values = nullptr;
+		quint32 nodeCount = 0;
+
+		// The links inside the records are only checked when they are followed, so opening stays free of
+		// parsing and a corrupt file cannot make a lookup leave the arrays. Broken links read as missing nodes.
+		inline const NodeRecord &node(quint32 index) const;
+		inline quint32 slotCount() const;
+		inline bool hasValidSlots(const NodeRecord &record) const;
+		inline quint32 slotNode(quint32 slot) const;
+		quint32 findChild(quint32 index, const TKey &key) const;
+		QList<TKey> key(quint32 index) const;
+	};
+
+	std::unique_ptr<Data> d;
+
+	static inline constexpr quint64 align(quint64 offset, quint64 alignment);
+	static inline const char *magic();
+};
+
+// GENERIC IMPLEMENTATION
+
+template <typename TKey, typename TValue>
+QFrozenTree<TKey, TValue>::ConstNode::operator bool() const
+{
+	return d;
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::ConstNode::operator!() const
+{
+	return !d;
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::ConstNode::operator==(const ConstNode &other) const
+{
+	return d == other.d && (!d || _index == other._index);
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::ConstNode::operator!=(const ConstNode &other) const
+{
+	return !operator==(other);
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::ConstNode::hasValue() const
+{
+	return d->node(_index).hasValue;
+}
+
+template <typename TKey, typename TValue>
+TValue QFrozenTree<TKey, TValue>::ConstNode::value(const TValue &defaultValue) const
+{
+	return d && d->node(_index).hasValue ? d->values[_index] : defaultValue;
+}
+
+template <typename TKey, typename TValue>
+const TValue &QFrozenTree<TKey, TValue>::ConstNode::operator*() const
+{
+	Q_ASSERT_X(hasValue(), Q_FUNC_INFO, "Cannot dereference a node without a value");
+	return d->values[_index];
+}
+
+template <typename TKey, typename TValue>
+const TValue *QFrozenTree<TKey, TValue>::ConstNode::operator->() const
+{
+	Q_ASSERT_X(hasValue(), Q_FUNC_INFO, "Cannot dereference a node without a value");
+	return &d->values[_index];
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::ConstNode::containsChild(const TKey &key) const
+{
+	return d->findChild(_index, key) != NoIndex;
+}
+
+template <typename TKey, typename TValue>
+int QFrozenTree<TKey, TValue>::ConstNode::childCount() const
+{
+	const auto &record = d->node(_index);
+	return d->hasValidSlots(record) ? static_cast<int>(record.childCount) : 0;
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::ConstNode::hasChildren() const
+{
+	return childCount() > 0;
+}
+
+template <typename TKey, typename TValue>
+QList<typename QFrozenTree<TKey, TValue>::ConstNode> QFrozenTree<TKey, TValue>::ConstNode::children() const
+{
+	const auto &record = d->node(_index);
+	QList<ConstNode> children;
+	if (!d->hasValidSlots(record))
+		return children;
+	children.reserve(static_cast<int>(record.childCount));
+	for (auto slot = record.firstSlot, end = record.firstSlot + record.childCount; slot != end; ++slot) {
+		const auto index = d->slotNode(slot);
+		if (index != NoIndex)
+			children.append(ConstNode{d, index});
+	}
+	return children;
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::ConstNode QFrozenTree<TKey, TValue>::ConstNode::child(const TKey &key) const
+{
+	const auto index = d->findChild(_index, key);
+	return index != NoIndex ? ConstNode{d, index} : ConstNode{};
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::ConstNode QFrozenTree<TKey, TValue>::ConstNode::operator[](const TKey &key) const
+{
+	return child(key);
+}
+
+template <typename TKey, typename TValue>
+int QFrozenTree<TKey, TValue>::ConstNode::depth() const
+{
+	return static_cast<int>(d->node(_index).depth);
+}
+
+template <typename TKey, typename TValue>
+QList<TKey> QFrozenTree<TKey, TValue>::ConstNode::key() const
+{
+	return d->key(_index);
+}
+
+template <typename TKey, typename TValue>
+TKey QFrozenTree<TKey, TValue>::ConstNode::subKey() const
+{
+	const auto &record = d->node(_index);
+	return record.slot < d->slotCount() ? d->keys[record.slot] : TKey{};
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::ConstNode QFrozenTree<TKey, TValue>::ConstNode::parent() const
+{
+	const auto parent = d->node(_index).parent;
+	return parent < d->nodeCount ? ConstNode{d, parent} : ConstNode{};
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::ConstNode QFrozenTree<TKey, TValue>::ConstNode::findChild(QGenericTreeKeySpan<TKey> keys) const
+{
+	if (!d)
+		return {};
+	auto index = _index;
+	for (const auto &key : keys) {
+		index = d->findChild(index, key);
+		if (index == NoIndex)
+			return {};
+	}
+	return ConstNode{d, index};
+}
+
+template <typename TKey, typename TValue>
+int QFrozenTree<TKey, TValue>::ConstNode::subtreeSize(bool valueOnly) const
+{
+	const auto &record = d->node(_index);
+	return static_cast<int>(valueOnly ? record.subtreeValues : record.subtreeNodes);
+}
+
+template <typename TKey, typename TValue>
+QFrozenTree<TKey, TValue>::ConstNode::ConstNode(const Data *data, quint32 index) :
+	d{data},
+	_index{index}
+{}
+
+
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::const_iterator::operator==(const const_iterator &other) const
+{
+	return _index == other._index;
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::const_iterator::operator!=(const const_iterator &other) const
+{
+	return _index != other._index;
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::const_iterator::reference QFrozenTree<TKey, TValue>::const_iterator::operator*() const
+{
+	Q_ASSERT_X(d->node(_index).hasValue, Q_FUNC_INFO, "Cannot dereference an iterator to a node without a value");
+	return d->values[_index];
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::const_iterator::pointer QFrozenTree<TKey, TValue>::const_iterator::operator->() const
+{
+	Q_ASSERT_X(d->node(_index).hasValue, Q_FUNC_INFO, "Cannot dereference an iterator to a node without a value");
+	return &d->values[_index];
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::const_iterator &QFrozenTree<TKey, TValue>::const_iterator::operator++()
+{
+	++_index;
+	return *this;
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::const_iterator QFrozenTree<TKey, TValue>::const_iterator::operator++(int)
+{
+	auto other = *this;
+	++_index;
+	return other;
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::const_iterator &QFrozenTree<TKey, TValue>::const_iterator::operator--()
+{
+	--_index;
+	return *this;
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::const_iterator QFrozenTree<TKey, TValue>::const_iterator::operator--(int)
+{
+	auto other = *this;
+	--_index;
+	return other;
+}
+
+template <typename TKey, typename TValue>
+QFrozenTree<TKey, TValue>::const_iterator::operator bool() const
+{
+	return d->node(_index).hasValue;
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::const_iterator::operator!() const
+{
+	return !d->node(_index).hasValue;
+}
+
+template <typename TKey, typename TValue>
+QList<TKey> QFrozenTree<TKey, TValue>::const_iterator::key() const
+{
+	return d->key(_index);
+}
+
+template <typename TKey, typename TValue>
+TKey QFrozenTree<TKey, TValue>::const_iterator::subKey() const
+{
+	return node().subKey();
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::ConstNode QFrozenTree<TKey, TValue>::const_iterator::node() const
+{
+	return ConstNode{d, _index};
+}
+
+template <typename TKey, typename TValue>
+QFrozenTree<TKey, TValue>::const_iterator::const_iterator(const Data *data, quint32 index) :
+	d{data},
+	_index{index}
+{}
+
+
+
+template <typename TKey, typename TValue>
+QFrozenTree<TKey, TValue>::QFrozenTree() = default;
+
+template <typename TKey, typename TValue>
+QFrozenTree<TKey, TValue>::QFrozenTree(const QString &fileName)
+{
+	open(fileName);
+}
+
+template <typename TKey, typename TValue>
+template <template<class, class> class TContainer, typename... TPolicies>
+bool QFrozenTree<TKey, TValue>::freeze(const QGenericTreeBase<TKey, TValue, TContainer, TPolicies...> &tree, const QString &fileName)
+{
+	using Node = typename QGenericTreeBase<TKey, TValue, TContainer, TPolicies...>::ConstNode;
+
+	const auto root = tree.rootNode();
+	const auto nodeCount = static_cast<quint64>(root.subtreeSize());
+	const auto slotCount = nodeCount - 1;
+	if (nodeCount >= NoIndex)
+		return false;
+
+	// the layout is known up front from the counters, so the file is sized once and filled in place.
+	// Every write is checked against that layout, so counters that do not match the nodes make freeze
+	// fail instead of writing past the arrays.
+	Header header{};
+	std::memcpy(header.magic, magic(), sizeof(header.magic));
+	header.version = Version;
+	header.byteOrder = ByteOrderMark;
+	header.keySize = sizeof(TKey);
+	header.valueSize = sizeof(TValue);
+	header.nodeCount = static_cast<quint32>(nodeCount);
+	header.nodeOffset = align(sizeof(Header), alignof(NodeRecord));
+	header.slotOffset = align(header.nodeOffset + nodeCount * sizeof(NodeRecord), alignof(quint32));
+	header.keyOffset = align(header.slotOffset + slotCount * sizeof(quint32), alignof(TKey));
+	header.valueOffset = align(header.keyOffset + slotCount * sizeof(TKey), alignof(TValue));
+	const auto size = header.valueOffset + nodeCount * sizeof(TValue);
+
+	QFile file{fileName};
+	if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+		return false;
+	auto map = file.resize(static_cast<qint64>(size)) ? file.map(0, static_cast<qint64>(size)) : nullptr;
+	if (!map) {
+		file.remove();
+		return false;
+	}
+	std::memcpy(map, &header, sizeof(Header));
+	const auto nodes = reinterpret_cast<NodeRecord*>(map + header.nodeOffset);
+	const auto slotNodes = reinterpret_cast<quint32*>(map + header.slotOffset);
+	const auto keys = map + header.keyOffset;
+	const auto values = map + header.valueOffset;
+
+	// preorder, with the children of every node sorted. The sorted children of the open nodes are kept
+	// per depth and reused between siblings, so only the deepest path ever needs memory.
+	using Entry = std::pair<TKey, Node>;
+	std::vector<std::vector<Entry>> levels;
+	QVarLengthArray<std::pair<quint32, quint32>, 16> path; // the open nodes and their next child
+	quint32 nextIndex = 0;
+	quint32 nextSlot = 0;
+	const auto visit = [&](const Node &node, quint32 parent, quint32 slot, quint32 depth) {
+		if (levels.size() <= depth)
+			levels.emplace_back();
+		auto &level = levels[depth];
+		level.clear();
+		for (const auto &child : node.children())
+			level.emplace_back(child.subKey(), child);
+		if (nextIndex == nodeCount || level.size() > slotCount - nextSlot)
+			return false;
+
+		const auto index = nextIndex++;
+		auto &record = nodes[index];
+		record.parent = parent;
+		record.slot = slot;
+		record.firstSlot = nextSlot;
+		record.childCount = static_cast<quint32>(level.size());
+		record.subtreeNodes = static_cast<quint32>(node.subtreeSize());
+		record.subtreeValues = static_cast<quint32>(node.subtreeSize(true));
+		record.depth = depth;
+		record.hasValue = node.hasValue();
+		nextSlot += record.childCount;
+		if (record.hasValue)
+			std::memcpy(values + index * sizeof(TValue), &*node, sizeof(TValue));
+		if (slot != NoIndex)
+			slotNodes[slot] = index;
+
+		const auto byKey = [](const Entry &lhs, const Entry &rhs) {
+			return lhs.first < rhs.first;
+		};
+		if (!std::is_sorted(level.cbegin(), level.cend(), byKey))
+			std::sort(level.begin(), level.end(), byKey);
+		for (quint32 i = 0; i < record.childCount; ++i)
+			std::memcpy(keys + (record.firstSlot + i) * sizeof(TKey), &level[i].first, sizeof(TKey));
+		path.append({index, 0});
+		return true;
+	};
+
+	auto complete = visit(root, NoIndex, NoIndex, 0);
+	while (complete && !path.isEmpty()) {
+		const auto depth = static_cast<quint32>(path.size() - 1);
+		auto &current = path.last();
+		if (current.second == nodes[current.first].childCount) {
+			path.removeLast();
+			continue;
+		}
+
+		const auto parent = current.first;
+		const auto position = current.second++;
+		// a copy, as visiting it may add a level
+		const auto child = levels[depth][position].second;
+		complete = visit(child, parent, nodes[parent].firstSlot + position, depth + 1);
+	}
+
+	file.unmap(map);
+	if (!complete || nextIndex != nodeCount || nextSlot != slotCount) {
+		file.remove();
+		return false;
+	}
+	return true;
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::open(const QString &fileName)
+{
+	close();
+	auto data = std::make_unique<Data>();
+	data->file.setFileName(fileName);
+	if (!data->file.open(QIODevice::ReadOnly))
+		return false;
+	const auto size = static_cast<quint64>(data->file.size());
+	if (size < sizeof(Header))
+		return false;
+	const auto map = data->file.map(0, static_cast<qint64>(size));
+	if (!map)
+		return false;
+
+	// the header is checked completely, so a valid header means all of the arrays are inside the file.
+	// The records themselves are checked by Data when their links are followed.
+	Header header;
+	std::memcpy(&header, map, sizeof(Header));
+	const auto sectionFits = [size](quint64 offset, quint64 count, quint64 elementSize, quint64 alignment) {
+		return offset % alignment == 0 &&
+			offset <= size &&
+			count <= (size - offset) / elementSize;
+	};
+	if (std::memcmp(header.magic, magic(), sizeof(header.magic)) != 0 ||
+		header.version != Version ||
+		header.byteOrder != ByteOrderMark ||
+		header.keySize != sizeof(TKey) ||
+		header.valueSize != sizeof(TValue) ||
+		header.nodeCount == 0 ||
+		header.nodeCount == NoIndex ||
+		!sectionFits(header.nodeOffset, header.nodeCount, sizeof(NodeRecord), alignof(NodeRecord)) ||
+		!sectionFits(header.slotOffset, header.nodeCount - 1, sizeof(quint32), alignof(quint32)) ||
+		!sectionFits(header.keyOffset, header.nodeCount - 1, sizeof(TKey), alignof(TKey)) ||
+		!sectionFits(header.valueOffset, header.nodeCount, sizeof(TValue), alignof(TValue)))
+		return false;
+
+	data->nodes = reinterpret_cast<const NodeRecord*>(map + header.nodeOffset);
+	data->slotNodes = reinterpret_cast<const quint32*>(map + header.slotOffset);
+	data->keys = reinterpret_cast<const TKey*>(map + header.keyOffset);
+	data->values = reinterpret_cast<const TValue*>(map + header.valueOffset);
+	data->nodeCount = header.nodeCount;
+	d = std::move(data);
+	return true;
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::isOpen() const
+{
+	return static_cast<bool>(d);
+}
+
+template <typename TKey, typename TValue>
+void QFrozenTree<TKey, TValue>::close()
+{
+	d.reset();
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::ConstNode QFrozenTree<TKey, TValue>::rootNode() const
+{
+	return d ? ConstNode{d.get(), 0} : ConstNode{};
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::contains(const TKey &key) const
+{
+	return d && d->findChild(0, key) != NoIndex;
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::contains(QGenericTreeKeySpan<TKey> key) const
+{
+	return static_cast<bool>(find(key));
+}
+
+template <typename TKey, typename TValue>
+int QFrozenTree<TKey, TValue>::countElements(bool valueOnly) const
+{
+	// like the trees, without the root node
+	if (!d)
+		return 0;
+	const auto &root = d->node(0);
+	return static_cast<int>(valueOnly ?
+		root.subtreeValues - root.hasValue :
+		root.subtreeNodes - 1);
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::ConstNode QFrozenTree<TKey, TValue>::find(QGenericTreeKeySpan<TKey> keys) const
+{
+	return rootNode().findChild(keys);
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::ConstNode QFrozenTree<TKey, TValue>::operator[](const TKey &key) const
+{
+	return d ? rootNode().child(key) : ConstNode{};
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::ConstNode QFrozenTree<TKey, TValue>::operator[](QGenericTreeKeySpan<TKey> key) const
+{
+	return find(key);
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::const_iterator QFrozenTree<TKey, TValue>::begin() const
+{
+	return d ? const_iterator{d.get(), 1} : const_iterator{};
+}
+
+template <typename TKey, typename TValue>
+typename QFrozenTree<TKey, TValue>::const_iterator QFrozenTree<TKey, TValue>::end() const
+{
+	return d ? const_iterator{d.get(), d->nodeCount} : const_iterator{};
+}
+
+template <typename TKey, typename TValue>
+constexpr quint64 QFrozenTree<TKey, TValue>::align(quint64 offset, quint64 alignment)
+{
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+template <typename TKey, typename TValue>
+const char *QFrozenTree<TKey, TValue>::magic()
+{
+	return "QFRZTREE";
+}
+
+
+
+template <typename TKey, typename TValue>
+const typename QFrozenTree<TKey, TValue>::NodeRecord &QFrozenTree<TKey, TValue>::Data::node(quint32 index) const
+{
+	// node indices only come from the root, the iterators and checked links
+	Q_ASSERT(index < nodeCount);
+	return nodes[index];
+}
+
+template <typename TKey, typename TValue>
+quint32 QFrozenTree<TKey, TValue>::Data::slotCount() const
+{
+	// every node but the root has a slot in its parent
+	return nodeCount - 1;
+}
+
+template <typename TKey, typename TValue>
+bool QFrozenTree<TKey, TValue>::Data::hasValidSlots(const NodeRecord &record) const
+{
+	return record.firstSlot <= slotCount() && record.childCount <= slotCount() - record.firstSlot;
+}
+
+template <typename TKey, typename TValue>
+quint32 QFrozenTree<TKey, TValue>::Data::slotNode(quint32 slot) const
+{
+	const auto index = slotNodes[slot];
+	return index < nodeCount ? index : NoIndex;
+}
+
+template <typename TKey, typename TValue>
+quint32 QFrozenTree<TKey, TValue>::Data::findChild(quint32 index, const TKey &key) const
+{
+	const auto &record = node(index);
+	if (!hasValidSlots(record))
+		return NoIndex;
+	const auto begin = keys + record.firstSlot;
+	const auto end = begin + record.childCount;
+	const auto it = std::lower_bound(begin, end, key);
+	if (it == end || key < *it)
+		return NoIndex;
+	return slotNode(record.firstSlot + static_cast<quint32>(it - begin));
+}
+
+template <typename TKey, typename TValue>
+QList<TKey> QFrozenTree<TKey, TValue>::Data::key(quint32 index) const
+{
+	// a node cannot be deeper than there are nodes, and a broken link on the way gives no key at all
+	const auto depth = node(index).depth;
+	if (depth >= nodeCount)
+		return {};
+	QList<TKey> keyChain;
+	keyChain.reserve(static_cast<int>(depth));
+	for (quint32 i = 0; i < depth; ++i) {
+		const auto &record = node(index);
+		if (record.slot >= slotCount() || record.parent >= nodeCount)
+			return {};
+		keyChain.prepend(keys[record.slot]);
+		index = record.parent;
+	}
+	return keyChain;
+}
+
+#endif // QFROZENTREE_H
@@ -1,6 +1,15 @@
 HEADERS += \
 	$$PWD/qgenerictreebase.h \
+	$$PWD/qgenerictreearena.h \
+	$$PWD/qgenerictreecbor.h \
+	$$PWD/qgenerictreeintrusive.h \
+	$$PWD/qconcurrenttree.h \
+	$$PWD/qflathash.h \
+	$$PWD/qflatmap.h \
+	$$PWD/qfrozentree.h \
 	$$PWD/qorderedtree.h \
+	$$PWD/qpathtree.h \
+	$$PWD/qsmallchildmap.h \
 	$$PWD/qunorderedtree.h
 
 INCLUDEPATH += $$PWD
@@ -0,0 +1,129 @@
+#ifndef QGENERICTREEARENA_H
+#define QGENERICTREEARENA_H
+
+#include "qgenerictreebase.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QtCore/QVector>
+
+// Carves nodes out of slabs that are shared by all nodes created from the same tree.
+// Every node keeps a plain pointer to the arena, copying it never touches a reference count. Instead, the
+// arena counts the chunks that are in use and releases itself and all of its slabs at once as soon as the
+// last one is freed, so nodes that outlive their tree keep it alive. Freed chunks are kept for reuse, and
+// QGenericTreeBase::clear releases them all at once when only the root node is left.
+// Neither allocation nor the chunk count are thread safe, so the arena can only be used together with
+// QGenericTreeIntrusivePointerPolicy, and only from one thread at a time, just like modifying the tree.
+class QGenericTreeArenaAllocator
+{
+public:
+	inline void *allocate(std::size_t size, std::size_t alignment) const;
+	inline void deallocate(void *ptr, std::size_t size, std::size_t alignment) const;
+	inline void releaseUnused(const void *lastChunk) const;
+
+private:
+	struct Arena {
+		static constexpr std::size_t MinSlabSize = 4 * 1024;
+		static constexpr std::size_t MaxSlabSize = 1024 * 1024;
+
+		int liveChunks = 0;
+		std::size_t chunkSize = 0;
+		std::size_t nextSlabSize = MinSlabSize;
+		char *cursor = nullptr;
+		char *slabEnd = nullptr;
+		void *freeList = nullptr;
+		QVector<std::pair<char*, std::size_t>> slabs;
+
+		inline ~Arena();
+	};
+
+	// created by the first allocation, which is why the allocator handed to the first node must be the
+	// one that its copies in all other nodes are made from. Like those copies, it may only be used to
+	// allocate while at least one of its chunks is in use.
+	mutable Arena *d = nullptr;
+};
+
+// GENERIC IMPLEMENTATION
+
+inline void *QGenericTreeArenaAllocator::allocate(std::size_t size, std::size_t alignment) const
+{
+	if (!d)
+		d = new Arena{};
+
+	// reuse freed chunks first
+	if (d->freeList) {
+		const auto chunk = d->freeList;
+		d->freeList = *static_cast<void**>(chunk);
+		++d->liveChunks;
+		return chunk;
+	}
+
+	Q_ASSERT_X(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, Q_FUNC_INFO, "Over-aligned node types are not supported");
+	const auto chunkSize = qMax((size + alignment - 1) / alignment * alignment, sizeof(void*));
+	Q_ASSERT_X(d->chunkSize == 0 || d->chunkSize == chunkSize, Q_FUNC_INFO, "An arena can only serve allocations of a single size");
+	d->chunkSize = chunkSize;
+
+	// start a new, larger slab once the current one is exhausted
+	if (static_cast<std::size_t>(d->slabEnd - d->cursor) < chunkSize) {
+		const auto slabSize = qMax(d->nextSlabSize, chunkSize);
+		d->cursor = static_cast<char*>(::operator new(slabSize));
+		d->slabEnd = d->cursor + slabSize;
+		d->slabs.append({d->cursor, slabSize});
+		d->nextSlabSize = qMin(d->nextSlabSize * 2, Arena::MaxSlabSize);
+	}
+
+	const auto chunk = d->cursor;
+	d->cursor += chunkSize;
+	++d->liveChunks;
+	return chunk;
+}
+
+inline void QGenericTreeArenaAllocator::deallocate(void *ptr, std::size_t size, std::size_t alignment) const
+{
+	Q_UNUSED(size)
+	Q_UNUSED(alignment)
+	if (--d->liveChunks == 0) {
+		delete d;
+		return;
+	}
+	*static_cast<void**>(ptr) = d->freeList;
+	d->freeList = ptr;
+}
+
+inline void QGenericTreeArenaAllocator::releaseUnused(const void *lastChunk) const
+{
+	// all other chunks are free, so instead of keeping them on the free list one by one, every slab but
+	// the one of the last chunk is released and the arena starts over with fresh slabs. Slabs are not
+	// tracked one by one, so as long as any other chunk is in use, nothing is released.
+	if (!d || d->liveChunks != 1)
+		return;
+
+	const auto chunk = static_cast<const char*>(lastChunk);
+	const auto keptIt = std::find_if(d->slabs.cbegin(), d->slabs.cend(), [chunk](const std::pair<char*, std::size_t> &slab) {
+		return chunk >= slab.first && chunk < slab.first + slab.second;
+	});
+	Q_ASSERT_X(keptIt != d->slabs.cend(), Q_FUNC_INFO, "The last chunk was not allocated from this arena");
+	if (keptIt == d->slabs.cend())
+		return;
+
+	const auto kept = *keptIt;
+	for (const auto &slab : qAsConst(d->slabs)) {
+		if (slab.first != kept.first)
+			::operator delete(slab.first);
+	}
+	// the rest of the kept slab is only used further if it is the current one
+	if (d->cursor < kept.first || d->cursor > kept.first + kept.second)
+		d->cursor = d->slabEnd = nullptr;
+	d->slabs = {kept};
+	d->freeList = nullptr;
+	d->nextSlabSize = Arena::MinSlabSize;
+}
+
+inline QGenericTreeArenaAllocator::Arena::~Arena()
+{
+	for (const auto &slab : qAsConst(slabs))
+		::operator delete(slab.first);
+}
+
+#endif // QGENERICTREEARENA_H
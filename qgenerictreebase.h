@@ -1,25 +1,227 @@
 #ifndef QGENERICTREEBASE_H
 #define QGENERICTREEBASE_H
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <optional>
+#include <initializer_list>
 #include <iterator>
+#include <memory>
+#include <new>
+#include <numeric>
 #include <type_traits>
+#include <vector>
 
+#include <QtCore/QDataStream>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QWeakPointer>
+#include <QtCore/QVarLengthArray>
+#include <QtCore/QVector>
+#include <QtCore/QSet>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QThreadPool>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+
+// detects child containers that can preallocate space for a number of children
+template <typename TContainer, typename = void>
+struct QGenericTreeHasReserve : std::false_type {};
+template <typename TContainer>
+struct QGenericTreeHasReserve<TContainer, std::void_t<decltype(std::declval<TContainer&>().reserve(0))>> : std::true_type {};
+
+// detects child containers that can insert with a position hint, like QMap
+template <typename TContainer, typename = void>
+struct QGenericTreeHasInsertHint : std::false_type {};
+template <typename TContainer>
+struct QGenericTreeHasInsertHint<TContainer, std::void_t<decltype(std::declval<TContainer&>().insert(std::declval<const TContainer&>().constEnd(),
+																									  std::declval<const typename TContainer::key_type&>(),
+																									  std::declval<const typename TContainer::mapped_type&>()))>> : std::true_type {};
+
+// detects allocators that can release all of their free memory at once, like QGenericTreeArenaAllocator
+template <typename TAllocator, typename = void>
+struct QGenericTreeHasReleaseUnused : std::false_type {};
+template <typename TAllocator>
+struct QGenericTreeHasReleaseUnused<TAllocator, std::void_t<decltype(std::declval<const TAllocator&>().releaseUnused(std::declval<const void*>()))>> : std::true_type {};
+
+// detects keys that can be used to look up children without converting them to TKey first, like a
+// QStringView for QString keys. The child container has to opt in by declaring an is_transparent type.
+// Pointers are never used as lookup keys, so string literals still convert to TKey.
+template <typename TContainer, typename TKey, typename TLookupKey, typename = void>
+struct QGenericTreeIsLookupKey : std::false_type {};
+template <typename TContainer, typename TKey, typename TLookupKey>
+struct QGenericTreeIsLookupKey<TContainer, TKey, TLookupKey, std::void_t<typename TContainer::is_transparent>> :
+	std::bool_constant<!std::is_same_v<std::decay_t<TLookupKey>, TKey> && !std::is_pointer_v<std::decay_t<TLookupKey>>> {};
+
+// A non owning view of a contiguous sequence of keys, to pass key paths without allocating a QList.
+// It can be created from initializer lists, arrays and any container with data() and size().
+template <typename TKey>
+class QGenericTreeKeySpan
+{
+public:
+	using value_type = TKey;
+	using const_iterator = const TKey*;
+
+	constexpr QGenericTreeKeySpan() = default;
+	constexpr QGenericTreeKeySpan(const TKey *data, int size);
+	constexpr QGenericTreeKeySpan(std::initializer_list<TKey> keys);
+	template <typename TKeyContainer, typename = std::enable_if_t<std::is_convertible_v<decltype(std::data(std::declval<const TKeyContainer&>())), const TKey*>>>
+	constexpr QGenericTreeKeySpan(const TKeyContainer &keys);
+
+	constexpr const TKey *data() const;
+	constexpr int size() const;
+	constexpr bool isEmpty() const;
+	constexpr const TKey &operator[](int index) const;
+	constexpr const_iterator begin() const;
+	constexpr const_iterator end() const;
+
+private:
+	const TKey *_data = nullptr;
+	int _size = 0;
+};
+
+// selects the overloads that work on several threads, e.g. tree.clone(QGenericTreeParallel)
+struct QGenericTreeParallelPolicy {
+	explicit constexpr QGenericTreeParallelPolicy() = default;
+};
+inline constexpr QGenericTreeParallelPolicy QGenericTreeParallel{};
+
+// Runs a number of tasks on the global thread pool. The calling thread works on the tasks as well, and
+// every thread takes the next open task as soon as it is done with its previous one, so threads that
+// finish early keep taking work off the others instead of idling.
+class QGenericTreeParallelRunner
+{
+public:
+	static inline void run(int taskCount, const std::function<void(int)> &task);
+
+private:
+	class Worker : public QRunnable
+	{
+	public:
+		inline Worker(std::atomic<int> &next, int taskCount, const std::function<void(int)> &task, QSemaphore *done = nullptr);
+		inline void run() override;
+		inline void work();
+
+	private:
+		std::atomic<int> &_next;
+		const int _taskCount;
+		const std::function<void(int)> &_task;
+		QSemaphore *_done;
+	};
+};
+
+class QGenericTreeHeapAllocator
+{
+public:
+	inline void *allocate(std::size_t size, std::size_t alignment) const;
+	inline void deallocate(void *ptr, std::size_t size, std::size_t alignment) const;
+};
+
+// Pointer policy for QGenericTreeBase that uses QSharedPointer, so nodes can be shared between threads.
+// It only supports the heap allocator, as QSharedPointer would allocate a separate control block for the
+// deleter of any other one. Use QGenericTreeIntrusivePointerPolicy with custom allocators.
+class QGenericTreeSharedPointerPolicy
+{
+public:
+	template <typename T>
+	using Pointer = QSharedPointer<T>;
+	template <typename T>
+	using WeakPointer = QWeakPointer<T>;
+	template <typename T>
+	using ParentPointer = QWeakPointer<T>;
+
+	template <typename T, typename TAllocator, typename... TArgs>
+	static inline Pointer<T> create(const TAllocator &allocator, TArgs&&... args);
+	template <typename T>
+	static inline Pointer<T> toPointer(const ParentPointer<T> &parent);
+	template <typename T>
+	static inline ParentPointer<T> toParent(const Pointer<T> &pointer);
+};
+
+// a subtree counter that can be changed from several threads at once
+class QGenericTreeAtomicCounter
+{
+public:
+	inline explicit QGenericTreeAtomicCounter(int value = 0);
+	inline QGenericTreeAtomicCounter(const QGenericTreeAtomicCounter &other);
+	inline QGenericTreeAtomicCounter &operator=(const QGenericTreeAtomicCounter &other);
+
+	inline operator int() const;
+	inline QGenericTreeAtomicCounter &operator+=(int value);
+	inline QGenericTreeAtomicCounter &operator-=(int value);
+	inline QGenericTreeAtomicCounter &operator++();
+
+private:
+	std::atomic<int> _value;
+};
+
+// Lock policy for QGenericTreeBase that does not lock at all. Like a Qt container, a tree can then only
+// be changed from one thread at a time.
+class QGenericTreeNoLockPolicy
+{
+public:
+	static constexpr bool IsLocking = false;
+
+	class Lock
+	{
+	public:
+		inline void lockForRead();
+		inline void lockForWrite();
+		inline void unlock();
+	};
+	using Counter = int;
+};
+
+// Lock policy for QGenericTreeBase that gives every node a lock of its own, which guards the value, the
+// children and the parent of that node. Disjoint subtrees can be changed from different threads at
+// once, and the counters of their common parents are updated atomically. Locks are only ever nested
+// from a parent to its children, so they cannot deadlock. The references returned by operator* and
+// operator-> are not guarded, and iterators, clones and the parallel algorithms must not run while the
+// tree is changed. Use it with the shared pointer policy, whose heap allocator is thread safe.
+// A node must not be changed while another thread detaches, takes or removes one of its ancestors.
+class QGenericTreeNodeLockPolicy
+{
+public:
+	static constexpr bool IsLocking = true;
+
+	using Lock = QReadWriteLock;
+	using Counter = QGenericTreeAtomicCounter;
+};
 
 template <typename TKey, typename TValue, template<class, class> class TContainer>
+class QConcurrentTree;
+
+template <typename TKey, typename TValue, template<class, class> class TContainer, typename TAllocator = QGenericTreeHeapAllocator, typename TPointerPolicy = QGenericTreeSharedPointerPolicy, typename TLockPolicy = QGenericTreeNoLockPolicy>
 class QGenericTreeBase
 {
+	template <typename, typename, template<class, class> class>
+	friend class QConcurrentTree;
+
 private:
 	struct NodeData;
-	using NodePtr = QSharedPointer<NodeData>;
-	using WeakNodePtr = QWeakPointer<NodeData>;
+	class NodeQueue;
+	using NodePtr = typename TPointerPolicy::template Pointer<NodeData>;
+	using WeakNodePtr = typename TPointerPolicy::template WeakPointer<NodeData>;
+	using ParentPtr = typename TPointerPolicy::template ParentPointer<NodeData>;
 	using Container = TContainer<TKey, NodePtr>;
+	using Lock = typename TLockPolicy::Lock;
+	using Counter = typename TLockPolicy::Counter;
+	template <typename TLookupKey>
+	using EnableIfLookupKey = std::enable_if_t<QGenericTreeIsLookupKey<Container, TKey, TLookupKey>::value>;
 
 public:
 	class ConstWeakNode;
 	class WeakNode;
+	template <typename TIterValue>
+	class bfs_iterator_base;
+	using bfs_iterator = bfs_iterator_base<TValue>;
+	using const_bfs_iterator = bfs_iterator_base<const TValue>;
+	template <typename TIterValue>
+	class postorder_iterator_base;
+	using postorder_iterator = postorder_iterator_base<TValue>;
+	using const_postorder_iterator = postorder_iterator_base<const TValue>;
+	template <typename TIterator>
+	class iterator_range;
 
 	class ConstNode
 	{
@@ -46,10 +248,14 @@ public:
 
 		// child access
 		bool containsChild(const TKey &key) const;
+		template <typename TLookupKey, typename = EnableIfLookupKey<TLookupKey>>
+		bool containsChild(const TLookupKey &key) const;
 		int childCount() const;
 		bool hasChildren() const;
 		QList<ConstNode> children() const;
 		ConstNode child(const TKey &key) const;
+		template <typename TLookupKey, typename = EnableIfLookupKey<TLookupKey>>
+		ConstNode child(const TLookupKey &key) const;
 		// child access operators
 		ConstNode operator[](const TKey &key) const;
 
@@ -59,13 +265,42 @@ public:
 		TKey subKey() const;
 		ConstNode parent() const;
 		ConstNode findChild(const QList<TKey> &keys) const;
+		ConstNode findChild(std::initializer_list<TKey> keys) const;
+		template <typename TLookupKey, typename = EnableIfLookupKey<TLookupKey>>
+		ConstNode findChild(std::initializer_list<TLookupKey> keys) const;
+		ConstNode findChild(QGenericTreeKeySpan<TKey> keys) const;
+		template <typename TIterator>
+		ConstNode findChild(TIterator begin, TIterator end) const;
+		int subtreeSize(bool valueOnly = false) const;
 
 		// other
 		void detach();
 		ConstNode clone() const;
+		ConstNode clone(QGenericTreeParallelPolicy policy) const;
 		ConstWeakNode toWeakNode() const;
 		void drop();
 
+		// parallel algorithms, over this node and all of its children. The functors are called from several
+		// threads at once. parallelReduce calls reduceFunctor(TResult &result, const TResult &value) and
+		// only keeps the preorder of the values, so the reduction must be associative.
+		template <typename TFunctor>
+		void parallelForEach(TFunctor &&functor) const;
+		template <typename TMapFunctor, typename TReduceFunctor, typename TResult = std::decay_t<std::invoke_result_t<TMapFunctor, const TValue&>>>
+		TResult parallelReduce(TMapFunctor &&mapFunctor, TReduceFunctor &&reduceFunctor, TResult initial = TResult{}) const;
+
+		// level order over all nodes below this one, or only those at the given depth below it
+		const_bfs_iterator bfs_begin() const;
+		const_bfs_iterator bfs_end() const;
+		iterator_range<const_bfs_iterator> levelRange(int depth) const;
+		// post order over all nodes below this one, so every node comes after all of its children
+		const_postorder_iterator postorder_begin() const;
+		const_postorder_iterator postorder_end() const;
+		// computes a result per node from bottom to top and returns the one of this node. The functor is called
+		// as functor(const ConstNode &node, iterator_range<const TResult*> childResults) and returns the TResult
+		// of the node. The results of the children are only valid during that call.
+		template <typename TResult, typename TFunctor>
+		TResult foldUp(TFunctor &&functor) const;
+
 	protected:
 		NodePtr d;
 
@@ -111,6 +346,8 @@ public:
 		QList<Node> children();
 		using ConstNode::child;
 		Node child(const TKey &key);
+		template <typename TLookupKey, typename = EnableIfLookupKey<TLookupKey>>
+		Node child(const TLookupKey &key);
 		void insertChild(const TKey &key, Node child);
 		Node emplaceChild(const TKey &key);
 		Node takeChild(const TKey &key);
@@ -125,11 +362,38 @@ public:
 		Node parent();
 		using ConstNode::findChild;
 		Node findChild(const QList<TKey> &keys);
+		Node findChild(std::initializer_list<TKey> keys);
+		template <typename TLookupKey, typename = EnableIfLookupKey<TLookupKey>>
+		Node findChild(std::initializer_list<TLookupKey> keys);
+		Node findChild(QGenericTreeKeySpan<TKey> keys);
+		template <typename TIterator>
+		Node findChild(TIterator begin, TIterator end);
 
 		// other
 		Node clone() const;
+		Node clone(QGenericTreeParallelPolicy policy) const;
 		WeakNode toWeakNode() const;
 
+		// parallel algorithms
+		using ConstNode::parallelForEach;
+		template <typename TFunctor>
+		void parallelForEach(TFunctor &&functor);
+		template <typename TFunctor>
+		void parallelMapValues(TFunctor &&functor);
+
+		// breadth first traversal
+		using ConstNode::bfs_begin;
+		bfs_iterator bfs_begin();
+		using ConstNode::bfs_end;
+		bfs_iterator bfs_end();
+		using ConstNode::levelRange;
+		iterator_range<bfs_iterator> levelRange(int depth);
+		// post order traversal
+		using ConstNode::postorder_begin;
+		postorder_iterator postorder_begin();
+		using ConstNode::postorder_end;
+		postorder_iterator postorder_end();
+
 	private:
 		friend class QGenericTreeBase;
 		friend class WeakNode;
@@ -191,7 +455,7 @@ public:
 		// LegacyIterator requirements
 		iterator_base(const iterator_base &other) = default;
 		iterator_base &operator=(const iterator_base &other) = default;
-		friend inline void swap(iterator_base &lhs, iterator_base &rhs) noexcept { swap(lhs._node, rhs._node); } // must be implemented inline because of the friend declaration
+		friend inline void swap(iterator_base &lhs, iterator_base &rhs) noexcept { swap(lhs._root, rhs._root); std::swap(lhs._path, rhs._path); } // must be implemented inline because of the friend declaration
 
 		// LegacyInputIterator & LegacyOutputIterator requirements
 		bool operator==(const iterator_base &other) const;
@@ -221,14 +485,186 @@ public:
 		std::enable_if_t<!std::is_const_v<SFINAE>, Node> node() const;
 
 	protected:
-		NodePtr _node;
+		using ChildIterator = typename Container::const_iterator;
 
-		iterator_base(NodePtr data);
+		// the path from the root to the current node, as iterators into the children of each level
+		// an empty path means the iterator points to the root node, which is the end iterator
+		NodePtr _root;
+		QVarLengthArray<ChildIterator, 16> _path;
+
+		iterator_base(NodePtr root, bool atBegin);
+
+	private:
+		inline NodeData *current() const;
+		inline NodeData *currentParent() const;
+		void descendLast(NodeData *node);
 	};
 
 	using iterator = iterator_base<TValue>;
 	using const_iterator = iterator_base<const TValue>;
 
+	// visits the nodes level by level. The pending nodes are queued as raw pointers in a ring buffer that
+	// grows to the widest level, so no reference counts are touched while iterating. Like the preorder
+	// iterators, they only stay valid as long as the tree is not changed.
+	template <typename TIterValue>
+	class bfs_iterator_base
+	{
+		friend class QGenericTreeBase;
+	public:
+		using value_type = TIterValue;
+		using difference_type = int;
+		using pointer = value_type*;
+		using reference = value_type&;
+		using iterator_category = std::forward_iterator_tag;
+
+		bfs_iterator_base() = default;
+
+		bool operator==(const bfs_iterator_base &other) const;
+		bool operator!=(const bfs_iterator_base &other) const;
+		reference operator*() const;
+		pointer operator->() const;
+		bfs_iterator_base &operator++();
+		bfs_iterator_base operator++(int);
+
+		explicit operator bool() const;
+		bool operator!() const;
+		int depth() const;
+		QList<TKey> key() const;
+		TKey subKey() const;
+		template<typename SFINAE = value_type>
+		std::enable_if_t<std::is_const_v<SFINAE>, ConstNode> node() const;
+		template<typename SFINAE = value_type>
+		std::enable_if_t<!std::is_const_v<SFINAE>, Node> node() const;
+
+	private:
+		NodePtr _root;
+		NodeQueue _queue;
+		int _depth = 0; // the depth of the current node, relative to the root
+		int _maxDepth = -1; // children below this depth are not queued, -1 for all levels
+		int _levelRemaining = 0; // the nodes of the current level that are still queued
+		int _nextLevel = 0; // the nodes of the next level that are already queued
+
+		bfs_iterator_base(NodePtr root, int firstDepth, int maxDepth);
+
+		inline NodeData *current() const;
+		void advance();
+	};
+
+	// visits every node after all of its children. The iterator knows the path to the current node, like the
+	// preorder iterators, so advancing is amortized O(1) and needs no stack of its own.
+	template <typename TIterValue>
+	class postorder_iterator_base
+	{
+		friend class QGenericTreeBase;
+	public:
+		using value_type = TIterValue;
+		using difference_type = int;
+		using pointer = value_type*;
+		using reference = value_type&;
+		using iterator_category = std::forward_iterator_tag;
+
+		postorder_iterator_base() = default;
+
+		bool operator==(const postorder_iterator_base &other) const;
+		bool operator!=(const postorder_iterator_base &other) const;
+		reference operator*() const;
+		pointer operator->() const;
+		postorder_iterator_base &operator++();
+		postorder_iterator_base operator++(int);
+
+		explicit operator bool() const;
+		bool operator!() const;
+		int depth() const;
+		QList<TKey> key() const;
+		TKey subKey() const;
+		template<typename SFINAE = value_type>
+		std::enable_if_t<std::is_const_v<SFINAE>, ConstNode> node() const;
+		template<typename SFINAE = value_type>
+		std::enable_if_t<!std::is_const_v<SFINAE>, Node> node() const;
+
+	private:
+		using ChildIterator = typename Container::const_iterator;
+
+		// an empty path means the iterator points to the root, which is the end iterator
+		NodePtr _root;
+		QVarLengthArray<ChildIterator, 16> _path;
+
+		postorder_iterator_base(NodePtr root, bool atBegin);
+
+		inline NodeData *current() const;
+		inline NodeData *currentParent() const;
+		void descendFirst(NodeData *node);
+	};
+
+	// preorder over either the nodes with a value or the leaves only. The value iterators skip every subtree
+	// without values using the subtree counters, so they take time in the number of values rather than the
+	// number of nodes. Every subtree has a leaf, so the leaf iterators never enter a subtree in vain.
+	template <typename TIterValue, bool TLeavesOnly>
+	class filtered_iterator_base
+	{
+		friend class QGenericTreeBase;
+	public:
+		using value_type = TIterValue;
+		using difference_type = int;
+		using pointer = value_type*;
+		using reference = value_type&;
+		using iterator_category = std::forward_iterator_tag;
+
+		filtered_iterator_base() = default;
+
+		bool operator==(const filtered_iterator_base &other) const;
+		bool operator!=(const filtered_iterator_base &other) const;
+		reference operator*() const;
+		pointer operator->() const;
+		filtered_iterator_base &operator++();
+		filtered_iterator_base operator++(int);
+
+		explicit operator bool() const;
+		bool operator!() const;
+		int depth() const;
+		QList<TKey> key() const;
+		TKey subKey() const;
+		template<typename SFINAE = value_type>
+		std::enable_if_t<std::is_const_v<SFINAE>, ConstNode> node() const;
+		template<typename SFINAE = value_type>
+		std::enable_if_t<!std::is_const_v<SFINAE>, Node> node() const;
+
+	private:
+		using ChildIterator = typename Container::const_iterator;
+
+		// an empty path means the iterator points to the root, which is the end iterator
+		NodePtr _root;
+		QVarLengthArray<ChildIterator, 16> _path;
+
+		filtered_iterator_base(NodePtr root, bool atBegin);
+
+		static inline bool enters(const NodeData *node);
+		static inline bool matches(const NodeData *node);
+		inline NodeData *current() const;
+		inline NodeData *currentParent() const;
+		void advance();
+	};
+
+	using value_iterator = filtered_iterator_base<TValue, false>;
+	using const_value_iterator = filtered_iterator_base<const TValue, false>;
+	using leaf_iterator = filtered_iterator_base<TValue, true>;
+	using const_leaf_iterator = filtered_iterator_base<const TValue, true>;
+
+	// a begin and end iterator pair, for range based for loops
+	template <typename TIterator>
+	class iterator_range
+	{
+	public:
+		iterator_range(TIterator begin, TIterator end);
+
+		TIterator begin() const;
+		TIterator end() const;
+
+	private:
+		TIterator _begin;
+		TIterator _end;
+	};
+
 	QGenericTreeBase() = default;
 	QGenericTreeBase(const QGenericTreeBase &other) = delete;
 	QGenericTreeBase &operator=(const QGenericTreeBase &other) = delete;
@@ -237,111 +673,267 @@ public:
 	friend inline void swap(QGenericTreeBase &lhs, QGenericTreeBase &rhs) noexcept { swap(lhs._root, rhs._root); } // must be implemented inline because of the friend declaration
 
 	static QGenericTreeBase makeTree(Node node);
+	template <typename TIterator>
+	static QGenericTreeBase fromSorted(TIterator begin, TIterator end);
+	static QGenericTreeBase readFrom(QDataStream &stream);
+	void writeTo(QDataStream &stream) const;
 
 	ConstNode rootNode() const;
 	Node rootNode();
 
 	bool contains(const TKey &key) const;
 	bool contains(const QList<TKey> &key) const;
+	bool contains(std::initializer_list<TKey> key) const;
+	template <typename TLookupKey, typename = EnableIfLookupKey<TLookupKey>>
+	bool contains(std::initializer_list<TLookupKey> key) const;
+	bool contains(QGenericTreeKeySpan<TKey> key) const;
+	template <typename TIterator>
+	bool contains(TIterator begin, TIterator end) const;
 	int countElements(bool valueOnly = false) const;
 	ConstNode find(const QList<TKey> &keys) const;
+	ConstNode find(std::initializer_list<TKey> keys) const;
+	template <typename TLookupKey, typename = EnableIfLookupKey<TLookupKey>>
+	ConstNode find(std::initializer_list<TLookupKey> keys) const;
+	ConstNode find(QGenericTreeKeySpan<TKey> keys) const;
+	template <typename TIterator>
+	ConstNode find(TIterator begin, TIterator end) const;
 	Node find(const QList<TKey> &keys);
+	Node find(std::initializer_list<TKey> keys);
+	template <typename TLookupKey, typename = EnableIfLookupKey<TLookupKey>>
+	Node find(std::initializer_list<TLookupKey> keys);
+	Node find(QGenericTreeKeySpan<TKey> keys);
+	template <typename TIterator>
+	Node find(TIterator begin, TIterator end);
 	ConstNode operator[](const TKey &key) const;
 	Node operator[](const TKey &key);
 	ConstNode operator[](const QList<TKey> &key) const;
+	ConstNode operator[](std::initializer_list<TKey> key) const;
+	ConstNode operator[](QGenericTreeKeySpan<TKey> key) const;
 	Node operator[](const QList<TKey> &key);
+	Node operator[](std::initializer_list<TKey> key);
+	Node operator[](QGenericTreeKeySpan<TKey> key);
 
 	iterator begin();
 	iterator end();
 	const_iterator begin() const;
 	const_iterator end() const;
+	// level order over all nodes but the root, or only the nodes at one depth (the children of the root have depth 1)
+	bfs_iterator bfs_begin();
+	bfs_iterator bfs_end();
+	const_bfs_iterator bfs_begin() const;
+	const_bfs_iterator bfs_end() const;
+	iterator_range<bfs_iterator> levelRange(int depth);
+	iterator_range<const_bfs_iterator> levelRange(int depth) const;
+	// only the nodes with a value, or only the leaves, in preorder and without the root
+	value_iterator valueBegin();
+	value_iterator valueEnd();
+	const_value_iterator valueBegin() const;
+	const_value_iterator valueEnd() const;
+	leaf_iterator leafBegin();
+	leaf_iterator leafEnd();
+	const_leaf_iterator leafBegin() const;
+	const_leaf_iterator leafEnd() const;
+	// post order over all nodes but the root
+	postorder_iterator postorder_begin();
+	postorder_iterator postorder_end();
+	const_postorder_iterator postorder_begin() const;
+	const_postorder_iterator postorder_end() const;
 
 	void clear();
 	QGenericTreeBase clone() const;
+	QGenericTreeBase clone(QGenericTreeParallelPolicy policy) const;
+
+	template <typename TFunctor>
+	void parallelForEach(TFunctor &&functor) const;
+	template <typename TFunctor>
+	void parallelForEach(TFunctor &&functor);
+	template <typename TFunctor>
+	void parallelMapValues(TFunctor &&functor);
+	template <typename TMapFunctor, typename TReduceFunctor, typename TResult = std::decay_t<std::invoke_result_t<TMapFunctor, const TValue&>>>
+	TResult parallelReduce(TMapFunctor &&mapFunctor, TReduceFunctor &&reduceFunctor, TResult initial = TResult{}) const;
+	// like ConstNode::foldUp, over the whole tree including the root
+	template <typename TResult, typename TFunctor>
+	TResult foldUp(TFunctor &&functor) const;
 
 private:
-	struct NodeData {
-		inline NodeData(WeakNodePtr parent = {});
-		inline NodeData(const NodeData &) = default;
-		inline NodeData &operator=(const NodeData &) = default;
-		inline NodeData(NodeData &&) noexcept = default;
-		inline NodeData &operator=(NodeData &&) noexcept = default;
-
-		WeakNodePtr parent;
+	// a share of the work of the parallel algorithms: either a whole subtree, or only the node itself
+	struct ParallelTask {
+		NodeData *node;
+		bool withChildren;
+		int parentTask; // the index of the task of the parent node, -1 for the root
+	};
+
+	template <typename TIterator>
+	Node createPath(TIterator begin, TIterator end);
+	// path copying for QConcurrentTree: nodes in the fresh set only belong to this tree and are changed in
+	// place, all others are shared with published versions and are copied before they are changed
+	QGenericTreeBase share() const;
+	NodeData *copyPath(QGenericTreeKeySpan<TKey> keys, bool create, QSet<const NodeData*> &fresh);
+	static QVector<ParallelTask> splitTasks(NodeData *root);
+	static NodePtr cloneParallel(NodeData *root);
+	template <typename TFunctor>
+	static void parallelForEachValue(const QVector<ParallelTask> &tasks, const NodeData *skipped, TFunctor &&functor);
+	template <typename TMapFunctor, typename TReduceFunctor, typename TResult>
+	static TResult parallelReduceValues(NodeData *root, const NodeData *skipped, TMapFunctor &mapFunctor, TReduceFunctor &reduceFunctor, TResult initial);
+
+	// lock a single node for the scope of the locker
+	class ReadLocker
+	{
+	public:
+		inline explicit ReadLocker(const NodeData *node);
+		inline ~ReadLocker();
+		Q_DISABLE_COPY(ReadLocker)
+
+	private:
+		Lock &_lock;
+	};
+
+	class WriteLocker
+	{
+	public:
+		inline explicit WriteLocker(const NodeData *node);
+		inline ~WriteLocker();
+		Q_DISABLE_COPY(WriteLocker)
+
+	private:
+		Lock &_lock;
+	};
+
+	// a FIFO ring buffer of pointers into the child containers, which doubles its capacity when full
+	class NodeQueue
+	{
+	public:
+		inline bool isEmpty() const;
+		inline const NodePtr &first() const;
+		void enqueue(const NodePtr *node);
+		inline void dequeue();
+
+	private:
+		QVector<const NodePtr*> _buffer;
+		int _head = 0;
+		int _size = 0;
+	};
+
+	// the allocator and the lock are inherited to avoid wasting memory on stateless ones
+	struct NodeData : private TAllocator, private Lock {
+		using allocator_type = TAllocator;
+
+		inline NodeData(const TAllocator &allocator, ParentPtr parent = {}, TKey subKey = {});
+		Q_DISABLE_COPY(NodeData)
+		~NodeData();
+
+		ParentPtr parent;
+		TKey subKey; // the key of this node within the parent, only valid if parent is set
 		Container children;
 		std::optional<TValue> value;
-
-		NodePtr find(const QList<TKey> &keys, int index, const NodePtr &current) const;
-		NodePtr clone() const;
+		// the number of nodes and of nodes with a value in the subtree, including this node
+		Counter subtreeNodes{1};
+		Counter subtreeValues{0};
+
+		template <typename... TArgs>
+		static NodePtr create(const TAllocator &allocator, TArgs&&... args);
+		static const NodePtr &appendChild(const NodePtr &parent, const TKey &key);
+		static const NodePtr &appendChild(const NodePtr &parent, const TKey &key, NodePtr child);
+		inline const TAllocator &allocator() const;
+		inline Lock &lock() const;
+		inline NodePtr lockParent() const;
+
+		template <typename TIterator>
+		static NodePtr find(TIterator begin, TIterator end, const NodePtr &current);
+		NodePtr clone(const TAllocator &allocator, ParentPtr parent = {}, const TKey &subKey = {}) const;
 		int depth() const;
 		QList<TKey> key() const;
+		void insertChild(const NodePtr &child);
+		template <typename TFunctor>
+		void forEachNode(TFunctor &functor);
+		inline void orphan();
+		void updateCounts(int nodes, int values);
+		inline void valueChanged(bool hadValue, bool hasValue);
 	};
 
 	Node _root;
 };
 
+template <typename TKey, typename TValue, template<class, class> class TContainer, typename... TPolicies>
+QDataStream &operator<<(QDataStream &stream, const QGenericTreeBase<TKey, TValue, TContainer, TPolicies...> &tree);
+template <typename TKey, typename TValue, template<class, class> class TContainer, typename... TPolicies>
+QDataStream &operator>>(QDataStream &stream, QGenericTreeBase<TKey, TValue, TContainer, TPolicies...> &tree);
+
 // GENERIC IMPLEMENTATION
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::operator bool() const {
-	return d;
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::operator bool() const {
+	return !d.isNull();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::operator!() const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::operator!() const {
 	return !d;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::operator==(const ConstNode &other) const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::operator==(const ConstNode &other) const
 {
 	return d == other.d;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::operator!=(const ConstNode &other) const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::operator!=(const ConstNode &other) const
 {
 	return d != other.d;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::hasValue() const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::hasValue() const {
+	const ReadLocker locker{&*d};
 	return d->value.has_value();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TDefault>
-TValue QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::value(TDefault &&defaultValue) const {
+TValue QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::value(TDefault &&defaultValue) const {
+	const ReadLocker locker{&*d};
 	return d->value.value_or(std::forward<TDefault>(defaultValue));
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-const TValue &QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::operator*() const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+const TValue &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::operator*() const {
 	return *(d->value);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-const TValue *QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::operator->() const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+const TValue *QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::operator->() const {
 	return d->value.operator->();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::containsChild(const TKey &key) const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::containsChild(const TKey &key) const {
+	const ReadLocker locker{&*d};
 	return d->children.contains(key);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-int QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::childCount() const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TLookupKey, typename>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::containsChild(const TLookupKey &key) const {
+	const ReadLocker locker{&*d};
+	return d->children.contains(key);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+int QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::childCount() const {
+	const ReadLocker locker{&*d};
 	return d->children.size();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::hasChildren() const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::hasChildren() const {
+	const ReadLocker locker{&*d};
 	return !d->children.empty();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QList<typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode> QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::children() const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QList<typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::children() const {
+	const ReadLocker locker{&*d};
 	QList<ConstNode> childList;
 	childList.reserve(d->children.size());
 	for (const auto &child : d->children)
@@ -349,154 +941,302 @@ QList<typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode> QGenericTr
 	return childList;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::child(const TKey &key) const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::child(const TKey &key) const {
+	const ReadLocker locker{&*d};
+	return d->children.value(key, NodePtr{});
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TLookupKey, typename>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::child(const TLookupKey &key) const {
+	const ReadLocker locker{&*d};
 	return d->children.value(key, NodePtr{});
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::operator[](const TKey &key) const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::operator[](const TKey &key) const {
 	return child(key);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-int QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::depth() const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+int QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::depth() const {
 	return d->depth();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QList<TKey> QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::key() const {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QList<TKey> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::key() const {
 	return d->key();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-TKey QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::subKey() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+TKey QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::subKey() const
 {
-	const auto parent = d->parent.toStrongRef();
-	if (!parent)
-		return {};
+	const ReadLocker locker{&*d};
+	return d->parent ? d->subKey : TKey{};
+}
 
-	// search myself within my parent to get my key
-	for (auto it = parent->children.begin(), end = parent->children.end(); it != end; ++it) {
-		if (*it == d)
-			return it.key();
-	}
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::parent() const {
+	return d->lockParent();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::findChild(const QList<TKey> &keys) const {
+	return NodeData::find(keys.cbegin(), keys.cend(), d);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::findChild(std::initializer_list<TKey> keys) const {
+	return NodeData::find(keys.begin(), keys.end(), d);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TLookupKey, typename>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::findChild(std::initializer_list<TLookupKey> keys) const {
+	return NodeData::find(keys.begin(), keys.end(), d);
+}
 
-	return {};
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::findChild(QGenericTreeKeySpan<TKey> keys) const {
+	return NodeData::find(keys.begin(), keys.end(), d);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::parent() const {
-	return d->parent.toStrongRef();
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterator>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::findChild(TIterator begin, TIterator end) const {
+	return NodeData::find(std::move(begin), std::move(end), d);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::findChild(const QList<TKey> &keys) const {
-	return d->find(keys, 0, d);
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+int QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::subtreeSize(bool valueOnly) const
+{
+	return valueOnly ? d->subtreeValues : d->subtreeNodes;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-void QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::detach()
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::detach()
 {
-	const auto parent = d->parent.toStrongRef();
+	const auto parent = d->lockParent();
 	if (!parent)
 		return;
 
-	for (auto it = parent->children.begin(), end = parent->children.end(); it != end; ++it) {
-		if (*it == d) {
+	// only erase the entry if it still refers to me, as the key might have been reassigned
+	auto erased = false;
+	{
+		const WriteLocker locker{&*parent};
+		const auto it = parent->children.find(d->subKey);
+		if (it != parent->children.end() && *it == d) {
 			parent->children.erase(it);
-			d->parent = nullptr;
-			break;
+			erased = true;
 		}
+		d->orphan();
 	}
+	if (erased)
+		parent->updateCounts(-d->subtreeNodes, -d->subtreeValues);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::clone() const {
+	return Node{d->clone(TAllocator{})};
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::clone() const {
-	Node clone{d->clone()};
-	clone.d->parent = nullptr;
-	return clone;
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::clone(QGenericTreeParallelPolicy policy) const {
+	Q_UNUSED(policy)
+	return Node{cloneParallel(&*d)};
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::ConstWeakNode QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::toWeakNode() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstWeakNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::toWeakNode() const
 {
 	return ConstWeakNode{*this};
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-void QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::drop()
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::drop()
 {
 	d.clear();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QGenericTreeBase<TKey, TValue, TContainer>::ConstNode::ConstNode(QGenericTreeBase::NodePtr data) :
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TFunctor>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::parallelForEach(TFunctor &&functor) const
+{
+	parallelForEachValue(splitTasks(&*d), nullptr, [&functor](int, const TValue &value) {
+		functor(value);
+	});
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TMapFunctor, typename TReduceFunctor, typename TResult>
+TResult QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::parallelReduce(TMapFunctor &&mapFunctor, TReduceFunctor &&reduceFunctor, TResult initial) const
+{
+	return parallelReduceValues(&*d, nullptr, mapFunctor, reduceFunctor, std::move(initial));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_bfs_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::bfs_begin() const
+{
+	return const_bfs_iterator{d, 1, -1};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_bfs_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::bfs_end() const
+{
+	return const_bfs_iterator{};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template iterator_range<typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_bfs_iterator> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::levelRange(int depth) const
+{
+	return {const_bfs_iterator{d, depth, depth}, const_bfs_iterator{}};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_postorder_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::postorder_begin() const
+{
+	return const_postorder_iterator{d, true};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_postorder_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::postorder_end() const
+{
+	return const_postorder_iterator{d, false};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TResult, typename TFunctor>
+TResult QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::foldUp(TFunctor &&functor) const
+{
+	// post order with a single stack of results: once a node is finished, the results of its children are
+	// the topmost entries of that stack and are replaced by the result of the node
+	using ChildIterator = typename Container::const_iterator;
+	struct Level {
+		const NodePtr *node;
+		ChildIterator next;
+		int firstResult;
+	};
+	QVarLengthArray<Level, 16> levels;
+	QVarLengthArray<TResult, 16> results; // contiguous for any TResult, unlike std::vector<bool>
+
+	levels.append({&d, d->children.cbegin(), 0});
+	while (!levels.isEmpty()) {
+		auto &level = levels.last();
+		const auto &node = *level.node;
+		if (level.next != node->children.cend()) {
+			const auto &child = *level.next++;
+			levels.append({&child, child->children.cbegin(), results.size()});
+			continue;
+		}
+
+		const auto firstResult = level.firstResult;
+		auto result = functor(ConstNode{node}, iterator_range<const TResult*>{results.constData() + firstResult, results.constData() + results.size()});
+		while (results.size() > firstResult)
+			results.removeLast();
+		results.append(std::move(result));
+		levels.removeLast();
+	}
+	return std::move(results.first());
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode::ConstNode(QGenericTreeBase::NodePtr data) :
 	d{std::move(data)}
 {}
 
 
 
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QGenericTreeBase<TKey, TValue, TContainer>::Node::Node() :
-	ConstNode{NodePtr::create()}
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::Node() :
+	ConstNode{NodeData::create(TAllocator{})}
 {}
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::Node::operator==(const Node &other) const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::operator==(const Node &other) const
 {
 	return this->d == other.d;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::Node::operator!=(const Node &other) const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::operator!=(const Node &other) const
 {
 	return this->d != other.d;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-void QGenericTreeBase<TKey, TValue, TContainer>::Node::setValue(TValue value) {
-	this->d->value = std::move(value);
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::setValue(TValue value) {
+	bool hadValue;
+	{
+		const WriteLocker locker{&*this->d};
+		hadValue = this->d->value.has_value();
+		this->d->value = std::move(value);
+	}
+	this->d->valueChanged(hadValue, true);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-TValue QGenericTreeBase<TKey, TValue, TContainer>::Node::takeValue() {
-	if (this->d->value) {
-		auto tValue = *std::move(this->d->value);
-		this->d->value = std::nullopt;
-		return tValue;
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+TValue QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::takeValue() {
+	std::optional<TValue> tValue;
+	{
+		const WriteLocker locker{&*this->d};
+		tValue.swap(this->d->value);
+	}
+	if (tValue) {
+		this->d->valueChanged(true, false);
+		return *std::move(tValue);
 	} else
 		return {};
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-void QGenericTreeBase<TKey, TValue, TContainer>::Node::clearValue() {
-	this->d->value = std::nullopt;
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::clearValue() {
+	bool hadValue;
+	{
+		const WriteLocker locker{&*this->d};
+		hadValue = this->d->value.has_value();
+		this->d->value = std::nullopt;
+	}
+	this->d->valueChanged(hadValue, false);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TAssign>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node &QGenericTreeBase<TKey, TValue, TContainer>::Node::operator=(TAssign &&value) {
-	this->d->value = std::forward<TAssign>(value);
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::operator=(TAssign &&value) {
+	bool hadValue;
+	{
+		const WriteLocker locker{&*this->d};
+		hadValue = this->d->value.has_value();
+		this->d->value = std::forward<TAssign>(value);
+	}
+	this->d->valueChanged(hadValue, true);
 	return *this;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-TValue &QGenericTreeBase<TKey, TValue, TContainer>::Node::operator*() {
-	if (!this->d->value.has_value())
-		return this->d->value.emplace();
-	else
-		return *(this->d->value);
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+TValue &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::operator*() {
+	auto emplaced = false;
+	{
+		const WriteLocker locker{&*this->d};
+		if (!this->d->value.has_value()) {
+			this->d->value.emplace();
+			emplaced = true;
+		}
+	}
+	if (emplaced)
+		this->d->valueChanged(false, true);
+	return *(this->d->value);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-TValue *QGenericTreeBase<TKey, TValue, TContainer>::Node::operator->() {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+TValue *QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::operator->() {
 	return this->d->value.operator->();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QList<typename QGenericTreeBase<TKey, TValue, TContainer>::Node> QGenericTreeBase<TKey, TValue, TContainer>::Node::children() {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QList<typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::children() {
+	const ReadLocker locker{&*this->d};
 	QList<Node> childList;
 	childList.reserve(this->d->children.size());
 	for (const auto &child : this->d->children)
@@ -504,467 +1244,2099 @@ QList<typename QGenericTreeBase<TKey, TValue, TContainer>::Node> QGenericTreeBas
 	return childList;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::Node::child(const TKey &key) {
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::child(const TKey &key) {
+	const ReadLocker locker{&*this->d};
+	return this->d->children.value(key, NodePtr{});
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TLookupKey, typename>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::child(const TLookupKey &key) {
+	const ReadLocker locker{&*this->d};
 	return this->d->children.value(key, NodePtr{});
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-void QGenericTreeBase<TKey, TValue, TContainer>::Node::insertChild(const TKey &key, Node child) {
-	child.d->parent = this->d.toWeakRef();
-	this->d->children.insert(key, child.d);
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::insertChild(const TKey &key, Node child) {
+	child.detach();
+	{
+		const WriteLocker locker{&*child.d};
+		child.d->parent = TPointerPolicy::toParent(this->d);
+		child.d->subKey = key;
+	}
+	this->d->insertChild(child.d);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::Node::emplaceChild(const TKey &key) {
-	Node child;
-	child.d->parent = this->d.toWeakRef();
-	this->d->children.insert(key, child.d);
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::emplaceChild(const TKey &key) {
+	Node child{NodeData::create(this->d->allocator(), TPointerPolicy::toParent(this->d), key)};
+	this->d->insertChild(child.d);
 	return child;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::Node::takeChild(const TKey &key) {
-	Node child{this->d->children.take(key)};
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::takeChild(const TKey &key) {
+	Node child{NodePtr{}};
+	{
+		const WriteLocker locker{&*this->d};
+		child.d = this->d->children.take(key);
+		if (child.d)
+			child.d->orphan();
+	}
 	if (child.d)
-		child.d->parent = nullptr;
+		this->d->updateCounts(-child.d->subtreeNodes, -child.d->subtreeValues);
 	return child;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::Node::removeChild(const TKey &key) {
-	return this->d->children.remove(key) > 0;
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::removeChild(const TKey &key) {
+	return static_cast<bool>(takeChild(key));
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-void QGenericTreeBase<TKey, TValue, TContainer>::Node::clearChildren() {
-	this->d->children.clear();
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::clearChildren() {
+	auto nodes = 0;
+	auto values = 0;
+	{
+		const WriteLocker locker{&*this->d};
+		for (const auto &child : qAsConst(this->d->children)) {
+			nodes -= child->subtreeNodes;
+			values -= child->subtreeValues;
+			child->orphan();
+		}
+		this->d->children.clear();
+	}
+	this->d->updateCounts(nodes, values);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::Node::operator[](const TKey &key) {
-	auto dIter = this->d->children.find(key);
-	if (dIter == this->d->children.end())
-		dIter = this->d->children.insert(key, NodePtr::create(this->d.toWeakRef()));
-	return *dIter;
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::operator[](const TKey &key) {
+	// with locks, existing children are looked up under a read lock first, so concurrent lookups do not block each other
+	if constexpr (TLockPolicy::IsLocking) {
+		const ReadLocker locker{&*this->d};
+		const auto dIter = this->d->children.constFind(key);
+		if (dIter != this->d->children.constEnd())
+			return *dIter;
+	}
+
+	NodePtr child;
+	auto created = false;
+	{
+		const WriteLocker locker{&*this->d};
+		auto dIter = this->d->children.find(key);
+		if (dIter == this->d->children.end()) {
+			dIter = this->d->children.insert(key, NodeData::create(this->d->allocator(), TPointerPolicy::toParent(this->d), key));
+			created = true;
+		}
+		child = *dIter;
+	}
+	if (created)
+		this->d->updateCounts(1, 0);
+	return child;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::Node::parent() {
-	return this->d->parent.toStrongRef();
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::parent() {
+	return this->d->lockParent();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::Node::findChild(const QList<TKey> &keys) {
-	return this->d->find(keys, 0, this->d);
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::findChild(const QList<TKey> &keys) {
+	return NodeData::find(keys.cbegin(), keys.cend(), this->d);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::Node::clone() const {
-	Node clone{this->d->clone()};
-	clone.d->parent = nullptr;
-	return clone;
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::findChild(std::initializer_list<TKey> keys) {
+	return NodeData::find(keys.begin(), keys.end(), this->d);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::WeakNode QGenericTreeBase<TKey, TValue, TContainer>::Node::toWeakNode() const
-{
-	return WeakNode{*this};
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TLookupKey, typename>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::findChild(std::initializer_list<TLookupKey> keys) {
+	return NodeData::find(keys.begin(), keys.end(), this->d);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QGenericTreeBase<TKey, TValue, TContainer>::Node::Node(QGenericTreeBase::NodePtr data) :
-	ConstNode{std::move(data)}
-{}
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::findChild(QGenericTreeKeySpan<TKey> keys) {
+	return NodeData::find(keys.begin(), keys.end(), this->d);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterator>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::findChild(TIterator begin, TIterator end) {
+	return NodeData::find(std::move(begin), std::move(end), this->d);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::clone() const {
+	return Node{this->d->clone(TAllocator{})};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::clone(QGenericTreeParallelPolicy policy) const {
+	Q_UNUSED(policy)
+	return Node{cloneParallel(&*this->d)};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::WeakNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::toWeakNode() const
+{
+	return WeakNode{*this};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TFunctor>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::parallelForEach(TFunctor &&functor)
+{
+	parallelForEachValue(splitTasks(&*this->d), nullptr, [&functor](int, TValue &value) {
+		functor(value);
+	});
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TFunctor>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::parallelMapValues(TFunctor &&functor)
+{
+	parallelForEachValue(splitTasks(&*this->d), nullptr, [&functor](int, TValue &value) {
+		value = functor(qAsConst(value));
+	});
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::bfs_begin()
+{
+	return bfs_iterator{this->d, 1, -1};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::bfs_end()
+{
+	return bfs_iterator{};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template iterator_range<typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::levelRange(int depth)
+{
+	return {bfs_iterator{this->d, depth, depth}, bfs_iterator{}};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::postorder_begin()
+{
+	return postorder_iterator{this->d, true};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::postorder_end()
+{
+	return postorder_iterator{this->d, false};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node::Node(QGenericTreeBase::NodePtr data) :
+	ConstNode{std::move(data)}
+{}
 
 
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QGenericTreeBase<TKey, TValue, TContainer>::ConstWeakNode::ConstWeakNode(const ConstNode &node) :
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstWeakNode::ConstWeakNode(const ConstNode &node) :
 	d{node.d}
 {}
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QGenericTreeBase<TKey, TValue, TContainer>::ConstWeakNode::operator bool() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstWeakNode::operator bool() const
 {
-	return this->d;
+	return !this->d.isNull();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::ConstWeakNode::operator!() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstWeakNode::operator!() const
 {
 	return !this->d;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode QGenericTreeBase<TKey, TValue, TContainer>::ConstWeakNode::toNode() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstWeakNode::toNode() const
 {
 	return Node{this->d.toStrongRef()};
 }
 
 
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QGenericTreeBase<TKey, TValue, TContainer>::WeakNode::WeakNode(const Node &node) :
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::WeakNode::WeakNode(const Node &node) :
 	ConstWeakNode{node}
 {}
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::WeakNode::toNode() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::WeakNode::toNode() const
 {
 	return Node{this->d.toStrongRef()};
 }
 
 
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-bool QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::operator==(const iterator_base &other) const
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::operator==(const iterator_base &other) const
 {
-	return _node == other._node;
+	return current() == other.current();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-bool QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::operator!=(const QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue> &other) const
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::operator!=(const QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue> &other) const
 {
-	return _node != other._node;
+	return current() != other.current();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-typename QGenericTreeBase<TKey, TValue, TContainer>::template iterator_base<TIterValue>::reference QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::operator*() const
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template iterator_base<TIterValue>::reference QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::operator*() const
 {
-	return *(this->_node->value);
+	return *(current()->value);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-typename QGenericTreeBase<TKey, TValue, TContainer>::template iterator_base<TIterValue>::pointer QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::operator->() const
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template iterator_base<TIterValue>::pointer QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::operator->() const
 {
-	return this->_node->value.operator->();
+	return current()->value.operator->();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-typename QGenericTreeBase<TKey, TValue, TContainer>::template iterator_base<TIterValue> &QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::operator++()
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template iterator_base<TIterValue> &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::operator++()
 {
 	// first step: check if at root node -> cant advance over end
-	if (!_node->parent)
+	if (_path.isEmpty())
 		return *this;
 
 	// second step: check for children -> if yes, advance to first child
-	if (!_node->children.empty()) {
-		_node = _node->children.first();
+	const auto node = current();
+	if (!node->children.empty()) {
+		_path.append(node->children.cbegin());
 		return *this;
 	}
 
-	// third step: go back to parent and check for siblings, in a loop
+	// third step: advance to the next sibling, going one layer up while there is none, in a loop
 	forever {
-		const auto parent = _node->parent.toStrongRef();
-		if (!parent) // no parent -> at root node -> cant advance over end
+		if (++_path.last() != currentParent()->children.cend())
+			return *this;
+		_path.removeLast();
+		if (_path.isEmpty()) // back at root node -> reached the end
 			return *this;
-
-		// search myself within my parent
-		for (auto it = parent->children.begin(), end = parent->children.end(); it != end; ++it) {
-			if (*it == _node) {
-				// if next element in child list still exists -> this one is next
-				if (++it != end) {
-					_node = *it;
-					return *this;
-				} else { // I am last element -> proceed one layer up
-					_node = parent;
-					break;
-				}
-			}
-		}
-
-		Q_ASSERT(_node == parent);
 	}
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-typename QGenericTreeBase<TKey, TValue, TContainer>::template iterator_base<TIterValue> QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::operator++(int)
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template iterator_base<TIterValue> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::operator++(int)
 {
 	auto copy = *this;
 	operator++();
 	return copy;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-typename QGenericTreeBase<TKey, TValue, TContainer>::template iterator_base<TIterValue> &QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::operator--()
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template iterator_base<TIterValue> &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::operator--()
 {
-	// first step: get parent -> no parent means at end -> walk to last valid element
-	const auto parent = _node->parent.toStrongRef();
-	if (!parent) {
-		// walk that one down to the outermost and deepest right element possible
-		while (!_node->children.empty())
-			_node = _node->children.last();
+	// first step: empty path means at end -> walk to last valid element
+	if (_path.isEmpty()) {
+		descendLast(_root.data());
 		return *this;
 	}
 
-	// second step: find self in parent list
-	for (auto it = parent->children.begin(), end = parent->children.end(); it != end; ++it) {
-		if (*it == _node) {
-			if (it != parent->children.begin()) {
-				// if previous element in child list still exists ->
-				// walk that one down to the outermost and deepst right element possible
-				_node = *--it;
-				while (!_node->children.empty())
-					_node = _node->children.last();
-				return *this;
-			} else { // I am first element -> proceed one layer up -> parent is next node
-				if (parent->parent) // parent has at parent -> not at begin
-					_node = parent;
-				// else: is at beginnig, can't go back
-				return *this;
-			}
-		}
-	}
-
-	Q_UNREACHABLE();
+	// second step: check for a previous sibling
+	if (_path.last() != currentParent()->children.cbegin()) {
+		// if previous element in child list still exists ->
+		// walk that one down to the outermost and deepst right element possible
+		--_path.last();
+		descendLast(current());
+	} else if (_path.size() > 1) // I am first element -> proceed one layer up -> parent is next node
+		_path.removeLast();
+	// else: is at beginnig, can't go back
+	return *this;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-typename QGenericTreeBase<TKey, TValue, TContainer>::template iterator_base<TIterValue> QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::operator--(int)
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template iterator_base<TIterValue> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::operator--(int)
 {
 	auto copy = *this;
 	operator--();
 	return copy;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::operator bool() const
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::operator bool() const
 {
-	return _node && _node->value;
+	const auto node = current();
+	return node && node->value;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-bool QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::operator!() const
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::operator!() const
 {
-	return !_node || !_node->value;
+	const auto node = current();
+	return !node || !node->value;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-QList<TKey> QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::key() const
+QList<TKey> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::key() const
 {
-	return Node{this->_node}.key();
+	QList<TKey> keyChain;
+	keyChain.reserve(_path.size());
+	for (const auto &it : _path)
+		keyChain.append(it.key());
+	return keyChain;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
-TKey QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::subKey() const
+TKey QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::subKey() const
 {
-	return Node{this->_node}.subKey();
+	return _path.isEmpty() ? TKey{} : _path.last().key();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
 template<typename SFINAE>
-std::enable_if_t<std::is_const_v<SFINAE>, typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode> QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::node() const
+std::enable_if_t<std::is_const_v<SFINAE>, typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::node() const
 {
-	return ConstNode{this->_node};
+	return ConstNode{_path.isEmpty() ? _root : *_path.last()};
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
 template <typename TIterValue>
 template<typename SFINAE>
-std::enable_if_t<!std::is_const_v<SFINAE>, typename QGenericTreeBase<TKey, TValue, TContainer>::Node> QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::node() const
+std::enable_if_t<!std::is_const_v<SFINAE>, typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::node() const
 {
-	return Node{this->_node};
+	return Node{_path.isEmpty() ? _root : *_path.last()};
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-template<typename TIterValue>
-QGenericTreeBase<TKey, TValue, TContainer>::iterator_base<TIterValue>::iterator_base(NodePtr data) :
-	_node{data}
-{}
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::iterator_base(NodePtr root, bool atBegin) :
+	_root{std::move(root)}
+{
+	if (atBegin && !_root->children.empty())
+		_path.append(_root->children.cbegin());
+}
 
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+inline typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData *QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::current() const
+{
+	return _path.isEmpty() ? _root.data() : _path.last()->data();
+}
 
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+inline typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData *QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::currentParent() const
+{
+	return _path.size() > 1 ? _path[_path.size() - 2]->data() : _root.data();
+}
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QGenericTreeBase<TKey, TValue, TContainer> QGenericTreeBase<TKey, TValue, TContainer>::makeTree(QGenericTreeBase::Node node)
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_base<TIterValue>::descendLast(NodeData *node)
 {
-	Q_ASSERT_X(!node.parent(), Q_FUNC_INFO, "Cannot create trees from nodes with a parent. Call clone or detach first.");
-	QGenericTreeBase<TKey, TValue, TContainer> tree;
-	tree._root = node;
-	return tree;
+	while (!node->children.empty()) {
+		auto it = node->children.cend();
+		_path.append(--it);
+		node = it->data();
+	}
+}
+
+
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::operator==(const bfs_iterator_base &other) const
+{
+	return current() == other.current();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode QGenericTreeBase<TKey, TValue, TContainer>::rootNode() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::operator!=(const bfs_iterator_base &other) const
 {
-	return _root;
+	return current() != other.current();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::rootNode()
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template bfs_iterator_base<TIterValue>::reference QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::operator*() const
 {
-	return _root;
+	return *(current()->value);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template bfs_iterator_base<TIterValue>::pointer QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::operator->() const
+{
+	return current()->value.operator->();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::contains(const QList<TKey> &key) const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template bfs_iterator_base<TIterValue> &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::operator++()
 {
-	return static_cast<bool>(_root.findChild(key));
+	if (!_queue.isEmpty())
+		advance();
+	return *this;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-bool QGenericTreeBase<TKey, TValue, TContainer>::contains(const TKey &key) const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template bfs_iterator_base<TIterValue> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::operator++(int)
 {
-	return _root.containsChild(key);
+	auto copy = *this;
+	operator++();
+	return copy;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::operator bool() const
+{
+	const auto node = current();
+	return node && node->value;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::operator!() const
+{
+	const auto node = current();
+	return !node || !node->value;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+int QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::depth() const
+{
+	return _depth;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+QList<TKey> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::key() const
+{
+	return current()->key();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+TKey QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::subKey() const
+{
+	return current()->subKey;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+template<typename SFINAE>
+std::enable_if_t<std::is_const_v<SFINAE>, typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::node() const
+{
+	return ConstNode{_queue.first()};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+template<typename SFINAE>
+std::enable_if_t<!std::is_const_v<SFINAE>, typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::node() const
+{
+	return Node{_queue.first()};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::bfs_iterator_base(NodePtr root, int firstDepth, int maxDepth) :
+	_root{std::move(root)},
+	_maxDepth{maxDepth},
+	_levelRemaining{1}
+{
+	// whole levels are expanded until the first one that is visited, so the root itself never is
+	Q_ASSERT_X(firstDepth > 0, Q_FUNC_INFO, "Levels start with the children of the root at depth 1");
+	_queue.enqueue(&_root);
+	while (!_queue.isEmpty() && _depth < firstDepth)
+		advance();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+inline typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData *QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::current() const
+{
+	return _queue.isEmpty() ? nullptr : _queue.first().data();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-int QGenericTreeBase<TKey, TValue, TContainer>::countElements(bool valueOnly) const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator_base<TIterValue>::advance()
 {
-	auto cnt = 0;
-	for (auto it = begin(), max = end(); it != max; ++it) {
-		if (!valueOnly || it)
-			++cnt;
+	const auto node = current();
+	_queue.dequeue();
+	if (_maxDepth < 0 || _depth < _maxDepth) {
+		for (auto it = node->children.cbegin(), end = node->children.cend(); it != end; ++it)
+			_queue.enqueue(&*it);
+		_nextLevel += static_cast<int>(node->children.size());
+	}
+	if (--_levelRemaining == 0) {
+		++_depth;
+		_levelRemaining = _nextLevel;
+		_nextLevel = 0;
 	}
-	return cnt;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode QGenericTreeBase<TKey, TValue, TContainer>::find(const QList<TKey> &keys) const
+
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::operator==(const postorder_iterator_base &other) const
 {
-	return _root.findChild(keys);
+	return current() == other.current();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::operator!=(const postorder_iterator_base &other) const
+{
+	return current() != other.current();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::find(const QList<TKey> &keys)
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template postorder_iterator_base<TIterValue>::reference QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::operator*() const
 {
-	return _root.findChild(keys);
+	return *(current()->value);
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode QGenericTreeBase<TKey, TValue, TContainer>::operator[](const TKey &key) const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template postorder_iterator_base<TIterValue>::pointer QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::operator->() const
 {
-	return _root[key];
+	return current()->value.operator->();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::operator[](const TKey &key)
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template postorder_iterator_base<TIterValue> &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::operator++()
 {
-	return _root[key];
+	// the root is the end and cannot be advanced over
+	if (_path.isEmpty())
+		return *this;
+
+	// the next sibling comes after its first leaf, without a sibling the parent is next
+	if (++_path.last() != currentParent()->children.cend())
+		descendFirst(current());
+	else
+		_path.removeLast();
+	return *this;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::ConstNode QGenericTreeBase<TKey, TValue, TContainer>::operator[](const QList<TKey> &key) const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template postorder_iterator_base<TIterValue> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::operator++(int)
 {
-	return _root->findChild(key);
+	auto copy = *this;
+	operator++();
+	return copy;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::Node QGenericTreeBase<TKey, TValue, TContainer>::operator[](const QList<TKey> &key)
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::operator bool() const
 {
-	auto cNode = _root;
-	for (const auto &subKey : key)
-		cNode = cNode[subKey];
-	return cNode;
+	const auto node = current();
+	return node && node->value;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::iterator QGenericTreeBase<TKey, TValue, TContainer>::begin()
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::operator!() const
 {
-	return _root.hasChildren() ?
-				_root.d->children.first() :
-				_root.d;
+	const auto node = current();
+	return !node || !node->value;
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::iterator QGenericTreeBase<TKey, TValue, TContainer>::end()
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+int QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::depth() const
 {
-	return _root.d;
+	return _path.size();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::const_iterator QGenericTreeBase<TKey, TValue, TContainer>::begin() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+QList<TKey> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::key() const
 {
-	return _root.hasChildren() ?
-				_root.d->children.first() :
-				_root.d;
+	return current()->key();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::const_iterator QGenericTreeBase<TKey, TValue, TContainer>::end() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+TKey QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::subKey() const
 {
-	return _root.d;
+	return _path.isEmpty() ? TKey{} : _path.last().key();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-void QGenericTreeBase<TKey, TValue, TContainer>::clear()
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+template<typename SFINAE>
+std::enable_if_t<std::is_const_v<SFINAE>, typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::node() const
 {
-	_root.clearValue();
-	_root.clearChildren();
+	return ConstNode{_path.isEmpty() ? _root : *_path.last()};
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QGenericTreeBase<TKey, TValue, TContainer> QGenericTreeBase<TKey, TValue, TContainer>::clone() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+template<typename SFINAE>
+std::enable_if_t<!std::is_const_v<SFINAE>, typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::node() const
 {
-	QGenericTreeBase<TKey, TValue, TContainer> cloned;
-	cloned._root = _root.clone();
-	return cloned;
+	return Node{_path.isEmpty() ? _root : *_path.last()};
 }
 
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::postorder_iterator_base(NodePtr root, bool atBegin) :
+	_root{std::move(root)}
+{
+	if (atBegin)
+		descendFirst(_root.data());
+}
 
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+inline typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData *QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::current() const
+{
+	return _path.isEmpty() ? _root.data() : _path.last()->data();
+}
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-inline QGenericTreeBase<TKey, TValue, TContainer>::NodeData::NodeData(WeakNodePtr parent) :
-	parent{std::move(parent)}
-{}
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+inline typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData *QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::currentParent() const
+{
+	return _path.size() > 1 ? _path[_path.size() - 2]->data() : _root.data();
+}
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::NodePtr QGenericTreeBase<TKey, TValue, TContainer>::NodeData::find(const QList<TKey> &keys, int index, const NodePtr &current) const {
-	if (index == keys.size())
-		return current;
-	else {
-		auto fChild = children.value(keys[index], NodePtr{});
-		return fChild ? fChild->find(keys, index + 1, fChild) : fChild;
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator_base<TIterValue>::descendFirst(NodeData *node)
+{
+	while (!node->children.empty()) {
+		_path.append(node->children.cbegin());
+		node = _path.last()->data();
 	}
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-typename QGenericTreeBase<TKey, TValue, TContainer>::NodePtr QGenericTreeBase<TKey, TValue, TContainer>::NodeData::clone() const {
-	auto cloned = NodePtr::create(*this);
-	for (auto it = cloned->children.begin(), end = cloned->children.end(); it != end; ++it) {
-		*it = (*it)->clone();
-		(*it)->parent = cloned.toWeakRef();
-	}
-	return cloned;
+
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::operator==(const filtered_iterator_base &other) const
+{
+	return current() == other.current();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-int QGenericTreeBase<TKey, TValue, TContainer>::NodeData::depth() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::operator!=(const filtered_iterator_base &other) const
 {
-	const auto strParent = parent.toStrongRef();
-	return strParent ? strParent->depth() + 1 : 0;
+	return current() != other.current();
 }
 
-template <typename TKey, typename TValue, template<class, class> typename TContainer>
-QList<TKey> QGenericTreeBase<TKey, TValue, TContainer>::NodeData::key() const
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template filtered_iterator_base<TIterValue, TLeavesOnly>::reference QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::operator*() const
 {
-	const auto strParent = parent.toStrongRef();
-	if (!strParent)
-		return {};
+	return *(current()->value);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template filtered_iterator_base<TIterValue, TLeavesOnly>::pointer QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::operator->() const
+{
+	return current()->value.operator->();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template filtered_iterator_base<TIterValue, TLeavesOnly> &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::operator++()
+{
+	// the root is the end and cannot be advanced over
+	if (!_path.isEmpty())
+		advance();
+	return *this;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template filtered_iterator_base<TIterValue, TLeavesOnly> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::operator++(int)
+{
+	auto copy = *this;
+	operator++();
+	return copy;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::operator bool() const
+{
+	const auto node = current();
+	return node && node->value;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::operator!() const
+{
+	const auto node = current();
+	return !node || !node->value;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+int QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::depth() const
+{
+	return _path.size();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+QList<TKey> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::key() const
+{
+	QList<TKey> keyChain;
+	keyChain.reserve(_path.size());
+	for (const auto &it : _path)
+		keyChain.append(it.key());
+	return keyChain;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+TKey QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::subKey() const
+{
+	return _path.isEmpty() ? TKey{} : _path.last().key();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+template<typename SFINAE>
+std::enable_if_t<std::is_const_v<SFINAE>, typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::node() const
+{
+	return ConstNode{_path.isEmpty() ? _root : *_path.last()};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+template<typename SFINAE>
+std::enable_if_t<!std::is_const_v<SFINAE>, typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::node() const
+{
+	return Node{_path.isEmpty() ? _root : *_path.last()};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::filtered_iterator_base(NodePtr root, bool atBegin) :
+	_root{std::move(root)}
+{
+	if (atBegin)
+		advance();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+inline bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::enters(const NodeData *node)
+{
+	if constexpr (TLeavesOnly) {
+		Q_UNUSED(node)
+		return true;
+	} else
+		return node->subtreeValues > 0;
+}
 
-	// search myself within my parent to get my key
-	for (auto it = strParent->children.begin(), end = strParent->children.end(); it != end; ++it) {
-		if (*it == this) {
-			auto keyChain = strParent->key();
-			keyChain.append(it.key());
-			return keyChain;
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+inline bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::matches(const NodeData *node)
+{
+	if constexpr (TLeavesOnly)
+		return node->children.empty();
+	else
+		return node->value.has_value();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+inline typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData *QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::current() const
+{
+	return _path.isEmpty() ? _root.data() : _path.last()->data();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+inline typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData *QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::currentParent() const
+{
+	return _path.size() > 1 ? _path[_path.size() - 2]->data() : _root.data();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterValue, bool TLeavesOnly>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::filtered_iterator_base<TIterValue, TLeavesOnly>::advance()
+{
+	forever {
+		// first step: descend into the first child worth entering
+		const auto node = current();
+		auto it = node->children.cbegin();
+		const auto end = node->children.cend();
+		while (it != end && !enters(it->data()))
+			++it;
+		if (it != end)
+			_path.append(it);
+		else {
+			// second step: advance to the next sibling worth entering, going one layer up while there is none
+			forever {
+				if (_path.isEmpty()) // back at root node -> reached the end
+					return;
+				const auto siblingsEnd = currentParent()->children.cend();
+				auto &last = _path.last();
+				do {
+					++last;
+				} while (last != siblingsEnd && !enters(last->data()));
+				if (last != siblingsEnd)
+					break;
+				_path.removeLast();
+			}
 		}
+
+		if (matches(current()))
+			return;
 	}
+}
 
-	return {};
+
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterator>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_range<TIterator>::iterator_range(TIterator begin, TIterator end) :
+	_begin{std::move(begin)},
+	_end{std::move(end)}
+{}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterator>
+TIterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_range<TIterator>::begin() const
+{
+	return _begin;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterator>
+TIterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator_range<TIterator>::end() const
+{
+	return _end;
+}
+
+
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::makeTree(QGenericTreeBase::Node node)
+{
+	Q_ASSERT_X(!node.parent(), Q_FUNC_INFO, "Cannot create trees from nodes with a parent. Call clone or detach first.");
+	QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> tree;
+	tree._root = node;
+	return tree;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterator>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::fromSorted(TIterator begin, TIterator end)
+{
+	// the entries are (path, value) pairs. They should be sorted by their paths, or at least grouped so that
+	// all paths with a common prefix follow each other. The nodes of the previous path are kept as a spine,
+	// so every entry only descends from where it differs from the previous one. New children are always
+	// the last ones of their parent, and the counters of a node are added to its parent once it is left.
+	// Entries that break the grouping still end up in the right place, because a node that was left before
+	// is looked up and entered again. Ordered containers skip that lookup for keys after the last child,
+	// so sorted input is appended without any, while unordered ones look up every new node.
+	QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> tree;
+	QVarLengthArray<const NodePtr*, 16> spine;
+	spine.append(&tree._root.d);
+	const auto leave = [&spine](int depth) {
+		while (spine.size() > depth) {
+			const auto &child = *spine.last();
+			spine.removeLast();
+			const auto &parent = *spine.last();
+			parent->subtreeNodes += child->subtreeNodes;
+			parent->subtreeValues += child->subtreeValues;
+		}
+	};
+
+	for (; begin != end; ++begin) {
+		const auto &entry = *begin;
+		auto keyIt = std::begin(entry.first);
+		const auto keyEnd = std::end(entry.first);
+
+		auto depth = 1;
+		for (; depth < spine.size() && keyIt != keyEnd && (*spine[depth])->subKey == *keyIt; ++depth, ++keyIt);
+		leave(depth);
+
+		for (; keyIt != keyEnd; ++keyIt) {
+			const auto &parent = *spine.last();
+			if constexpr (QGenericTreeHasInsertHint<Container>::value) {
+				if (parent->children.isEmpty() || parent->children.last()->subKey < *keyIt) {
+					spine.append(&NodeData::appendChild(parent, *keyIt));
+					continue;
+				}
+			}
+			const auto existing = parent->children.find(*keyIt);
+			if (existing != parent->children.end()) {
+				// its counters are added again when it is left the next time
+				parent->subtreeNodes -= (*existing)->subtreeNodes;
+				parent->subtreeValues -= (*existing)->subtreeValues;
+				spine.append(&*existing);
+			} else
+				spine.append(&NodeData::appendChild(parent, *keyIt));
+		}
+
+		const auto &node = *spine.last();
+		if (!node->value)
+			++node->subtreeValues;
+		node->value = entry.second;
+	}
+
+	leave(1);
+	return tree;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::readFrom(QDataStream &stream)
+{
+	// the preorder encoding is built up like fromSorted does, with the open nodes as a spine and the
+	// counters of a node added to its parent once all of its children are read
+	QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> tree;
+	struct Level {
+		const NodePtr *node;
+		qint32 remaining;
+	};
+	QVarLengthArray<Level, 16> spine;
+	const auto readNode = [&stream, &spine](const NodePtr &node) {
+		bool hasValue = false;
+		stream >> hasValue;
+		if (hasValue) {
+			TValue value;
+			stream >> value;
+			node->value = std::move(value);
+			node->subtreeValues = Counter{1};
+		}
+		qint32 childCount = 0;
+		stream >> childCount;
+		if (childCount < 0)
+			stream.setStatus(QDataStream::ReadCorruptData);
+		else if constexpr (QGenericTreeHasReserve<Container>::value) {
+			// the count comes from the stream, so a corrupt one must not allocate more than a few children
+			// up front. Larger nodes grow as their children are actually read.
+			constexpr qint32 MaxReserve = 1024;
+			node->children.reserve(qMin(childCount, MaxReserve));
+		}
+		spine.append({&node, childCount});
+	};
+
+	readNode(tree._root.d);
+	while (!spine.isEmpty() && stream.status() == QDataStream::Ok) {
+		auto &level = spine.last();
+		if (level.remaining <= 0) {
+			const auto &child = *level.node;
+			spine.removeLast();
+			if (!spine.isEmpty()) {
+				const auto &parent = *spine.last().node;
+				parent->subtreeNodes += child->subtreeNodes;
+				parent->subtreeValues += child->subtreeValues;
+			}
+			continue;
+		}
+
+		--level.remaining;
+		TKey key;
+		stream >> key;
+		const auto &parent = *level.node;
+		const auto childCount = parent->children.size();
+		const auto &child = NodeData::appendChild(parent, key);
+		if (parent->children.size() == childCount)
+			stream.setStatus(QDataStream::ReadCorruptData); // the key was read twice
+		readNode(child);
+	}
+
+	if (stream.status() != QDataStream::Ok)
+		tree.clear();
+	return tree;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::writeTo(QDataStream &stream) const
+{
+	// preorder: the value flag, the value, the number of children, and then every child as its key
+	// followed by its own encoding. The path is kept as child iterators, like the iterators do.
+	using ChildIterator = typename Container::const_iterator;
+	QVarLengthArray<std::pair<ChildIterator, ChildIterator>, 16> path;
+	const auto writeNode = [&stream, &path](const NodeData *node) {
+		stream << node->value.has_value();
+		if (node->value)
+			stream << *node->value;
+		stream << static_cast<qint32>(node->children.size());
+		path.append({node->children.cbegin(), node->children.cend()});
+	};
+
+	writeNode(&*_root.d);
+	while (!path.isEmpty()) {
+		auto &level = path.last();
+		if (level.first == level.second) {
+			path.removeLast();
+			continue;
+		}
+
+		const auto it = level.first++;
+		stream << it.key();
+		writeNode(&**it);
+	}
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::rootNode() const
+{
+	return _root;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::rootNode()
+{
+	return _root;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::contains(const QList<TKey> &key) const
+{
+	return static_cast<bool>(_root.findChild(key));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::contains(std::initializer_list<TKey> key) const
+{
+	return static_cast<bool>(_root.findChild(key));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TLookupKey, typename>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::contains(std::initializer_list<TLookupKey> key) const
+{
+	return static_cast<bool>(_root.findChild(key));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::contains(QGenericTreeKeySpan<TKey> key) const
+{
+	return static_cast<bool>(_root.findChild(key));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterator>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::contains(TIterator begin, TIterator end) const
+{
+	return static_cast<bool>(_root.findChild(std::move(begin), std::move(end)));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::contains(const TKey &key) const
+{
+	return _root.containsChild(key);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+int QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::countElements(bool valueOnly) const
+{
+	// the root node itself is not an element
+	return valueOnly ?
+		_root.d->subtreeValues - (_root.d->value ? 1 : 0) :
+		_root.d->subtreeNodes - 1;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::find(const QList<TKey> &keys) const
+{
+	return _root.findChild(keys);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::find(std::initializer_list<TKey> keys) const
+{
+	return _root.findChild(keys);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TLookupKey, typename>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::find(std::initializer_list<TLookupKey> keys) const
+{
+	return _root.findChild(keys);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::find(QGenericTreeKeySpan<TKey> keys) const
+{
+	return _root.findChild(keys);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterator>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::find(TIterator begin, TIterator end) const
+{
+	return _root.findChild(std::move(begin), std::move(end));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::find(const QList<TKey> &keys)
+{
+	return _root.findChild(keys);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::find(std::initializer_list<TKey> keys)
+{
+	return _root.findChild(keys);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TLookupKey, typename>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::find(std::initializer_list<TLookupKey> keys)
+{
+	return _root.findChild(keys);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::find(QGenericTreeKeySpan<TKey> keys)
+{
+	return _root.findChild(keys);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterator>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::find(TIterator begin, TIterator end)
+{
+	return _root.findChild(std::move(begin), std::move(end));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::operator[](const TKey &key) const
+{
+	return _root[key];
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::operator[](const TKey &key)
+{
+	return _root[key];
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::operator[](const QList<TKey> &key) const
+{
+	return _root.findChild(key);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::operator[](std::initializer_list<TKey> key) const
+{
+	return _root.findChild(key);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ConstNode QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::operator[](QGenericTreeKeySpan<TKey> key) const
+{
+	return _root.findChild(key);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::operator[](const QList<TKey> &key)
+{
+	return createPath(key.cbegin(), key.cend());
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::operator[](std::initializer_list<TKey> key)
+{
+	return createPath(key.begin(), key.end());
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::operator[](QGenericTreeKeySpan<TKey> key)
+{
+	return createPath(key.begin(), key.end());
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::begin()
+{
+	return iterator{_root.d, true};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::end()
+{
+	return iterator{_root.d, false};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::begin() const
+{
+	return const_iterator{_root.d, true};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::end() const
+{
+	return const_iterator{_root.d, false};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_begin()
+{
+	return _root.bfs_begin();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_end()
+{
+	return _root.bfs_end();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_bfs_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_begin() const
+{
+	return qAsConst(_root).bfs_begin();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_bfs_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_end() const
+{
+	return qAsConst(_root).bfs_end();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template iterator_range<typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::bfs_iterator> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::levelRange(int depth)
+{
+	return _root.levelRange(depth);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::template iterator_range<typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_bfs_iterator> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::levelRange(int depth) const
+{
+	return qAsConst(_root).levelRange(depth);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::value_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::valueBegin()
+{
+	return value_iterator{_root.d, true};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::value_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::valueEnd()
+{
+	return value_iterator{_root.d, false};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_value_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::valueBegin() const
+{
+	return const_value_iterator{_root.d, true};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_value_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::valueEnd() const
+{
+	return const_value_iterator{_root.d, false};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::leaf_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::leafBegin()
+{
+	return leaf_iterator{_root.d, true};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::leaf_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::leafEnd()
+{
+	return leaf_iterator{_root.d, false};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_leaf_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::leafBegin() const
+{
+	return const_leaf_iterator{_root.d, true};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_leaf_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::leafEnd() const
+{
+	return const_leaf_iterator{_root.d, false};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_begin()
+{
+	return _root.postorder_begin();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_end()
+{
+	return _root.postorder_end();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_postorder_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_begin() const
+{
+	return qAsConst(_root).postorder_begin();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::const_postorder_iterator QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::postorder_end() const
+{
+	return qAsConst(_root).postorder_end();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::clear()
+{
+	_root.clearValue();
+	_root.clearChildren();
+	// if no other node of the allocator is left, its free memory is released in one go. The children are
+	// still freed one by one before, and nothing is released while any other node of the allocator lives,
+	// e.g. a taken child or a held node handle, so the free chunks then stay with the allocator for reuse.
+	if constexpr (QGenericTreeHasReleaseUnused<TAllocator>::value)
+		_root.d->allocator().releaseUnused(&*_root.d);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::clone() const
+{
+	QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> cloned;
+	cloned._root = _root.clone();
+	return cloned;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::clone(QGenericTreeParallelPolicy policy) const
+{
+	QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> cloned;
+	cloned._root = _root.clone(policy);
+	return cloned;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TFunctor>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::parallelForEach(TFunctor &&functor) const
+{
+	// the root node itself is not an element
+	parallelForEachValue(splitTasks(&*_root.d), &*_root.d, [&functor](int, const TValue &value) {
+		functor(value);
+	});
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TFunctor>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::parallelForEach(TFunctor &&functor)
+{
+	parallelForEachValue(splitTasks(&*_root.d), &*_root.d, [&functor](int, TValue &value) {
+		functor(value);
+	});
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TFunctor>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::parallelMapValues(TFunctor &&functor)
+{
+	parallelForEachValue(splitTasks(&*_root.d), &*_root.d, [&functor](int, TValue &value) {
+		value = functor(qAsConst(value));
+	});
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TMapFunctor, typename TReduceFunctor, typename TResult>
+TResult QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::parallelReduce(TMapFunctor &&mapFunctor, TReduceFunctor &&reduceFunctor, TResult initial) const
+{
+	return parallelReduceValues(&*_root.d, &*_root.d, mapFunctor, reduceFunctor, std::move(initial));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TResult, typename TFunctor>
+TResult QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::foldUp(TFunctor &&functor) const
+{
+	return qAsConst(_root).template foldUp<TResult>(std::forward<TFunctor>(functor));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterator>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Node QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::createPath(TIterator begin, TIterator end)
+{
+	auto cNode = _root;
+	for (; begin != end; ++begin)
+		cNode = cNode[*begin];
+	return cNode;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::share() const
+{
+	QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy> tree;
+	tree._root = _root;
+	return tree;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData *QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::copyPath(QGenericTreeKeySpan<TKey> keys, bool create, QSet<const NodeData*> &fresh)
+{
+	if (!create && !NodeData::find(keys.begin(), keys.end(), _root.d))
+		return nullptr;
+
+	// the children are shared by copying the container, so the children of copied nodes keep their old parent
+	const auto copyNode = [&fresh](NodePtr &node, ParentPtr parent) {
+		if (fresh.contains(&*node))
+			return;
+		auto copied = NodeData::create(node->allocator(), std::move(parent), node->subKey);
+		copied->children = node->children;
+		copied->value = node->value;
+		copied->subtreeNodes = node->subtreeNodes;
+		copied->subtreeValues = node->subtreeValues;
+		fresh.insert(&*copied);
+		node = std::move(copied);
+	};
+
+	auto node = &_root.d;
+	copyNode(*node, ParentPtr{});
+	for (const auto &key : keys) {
+		auto &children = (*node)->children;
+		auto it = children.find(key);
+		if (it == children.end()) {
+			auto child = NodeData::create((*node)->allocator(), TPointerPolicy::toParent(*node), key);
+			fresh.insert(&*child);
+			it = children.insert(key, std::move(child));
+			(*node)->updateCounts(1, 0);
+		} else
+			copyNode(*it, TPointerPolicy::toParent(*node));
+		node = &*it;
+	}
+	return &**node;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QVector<typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ParallelTask> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::splitTasks(NodeData *root)
+{
+	// heavy subtrees are split up until every thread gets several tasks, so trees with uneven subtrees are
+	// shared between the threads as well. Thanks to the subtree counters only the heavy nodes are visited.
+	constexpr auto MinTaskSize = 1024;
+	const auto grain = qMax(MinTaskSize, root->subtreeNodes / (QThreadPool::globalInstance()->maxThreadCount() * 16));
+	// The heavy nodes are walked in preorder with their remaining children kept on a stack, like writeTo does.
+	using ChildIterator = typename Container::const_iterator;
+	struct Level {
+		ChildIterator next;
+		ChildIterator end;
+		int task;
+	};
+	QVector<ParallelTask> tasks;
+	QVarLengthArray<Level, 16> levels;
+	const auto split = [&tasks, &levels, grain](NodeData *node, int parentTask) {
+		if (node->subtreeNodes <= grain)
+			tasks.append({node, true, parentTask});
+		else {
+			levels.append({node->children.cbegin(), node->children.cend(), tasks.size()});
+			tasks.append({node, false, parentTask});
+		}
+	};
+
+	split(root, -1);
+	while (!levels.isEmpty()) {
+		auto &level = levels.last();
+		if (level.next == level.end) {
+			levels.removeLast();
+			continue;
+		}
+
+		// split may grow the stack, which moves the level
+		const auto task = level.task;
+		const auto &child = *level.next++;
+		split(&*child, task);
+	}
+	return tasks;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodePtr QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::cloneParallel(NodeData *root)
+{
+	// the nodes of the heavy tasks are copied without their children first, so every subtree task already
+	// finds the clone of its parent. The subtrees are then cloned concurrently, each with an allocator of
+	// its own, as allocators do not have to be thread safe. Finally all clones are linked to their parents
+	// in preorder, which inserts the children of every node in the same order as the serial clone.
+	const auto tasks = splitTasks(root);
+	std::vector<NodePtr> clones(static_cast<std::size_t>(tasks.size()));
+	const auto parentOf = [&](const ParallelTask &task) {
+		return task.parentTask < 0 ? ParentPtr{} : TPointerPolicy::toParent(clones[static_cast<std::size_t>(task.parentTask)]);
+	};
+	const auto subKeyOf = [&](const ParallelTask &task) {
+		return task.parentTask < 0 ? TKey{} : task.node->subKey;
+	};
+
+	// the heavy nodes are copied by this thread alone, so they all share one allocator
+	const TAllocator allocator{};
+	std::vector<int> subtreeTasks;
+	for (auto i = 0; i < tasks.size(); ++i) {
+		const auto &task = tasks[i];
+		if (task.withChildren) {
+			subtreeTasks.push_back(i);
+			continue;
+		}
+
+		auto &cloned = clones[static_cast<std::size_t>(i)];
+		cloned = NodeData::create(allocator, parentOf(task), subKeyOf(task));
+		cloned->value = task.node->value;
+		cloned->subtreeNodes = task.node->subtreeNodes;
+		cloned->subtreeValues = task.node->subtreeValues;
+		if constexpr (QGenericTreeHasReserve<Container>::value)
+			cloned->children.reserve(task.node->children.size());
+	}
+
+	// the largest subtrees are started first, so the small ones fill the gaps at the end
+	std::stable_sort(subtreeTasks.begin(), subtreeTasks.end(), [&tasks](int lhs, int rhs) {
+		return tasks[lhs].node->subtreeNodes > tasks[rhs].node->subtreeNodes;
+	});
+	QGenericTreeParallelRunner::run(static_cast<int>(subtreeTasks.size()), [&](int index) {
+		const auto taskIndex = subtreeTasks[static_cast<std::size_t>(index)];
+		const auto &task = tasks[taskIndex];
+		clones[static_cast<std::size_t>(taskIndex)] = task.node->clone(TAllocator{}, parentOf(task), subKeyOf(task));
+	});
+
+	for (auto i = 1; i < tasks.size(); ++i) {
+		const auto &task = tasks[i];
+		clones[static_cast<std::size_t>(task.parentTask)]->children.insert(task.node->subKey, clones[static_cast<std::size_t>(i)]);
+	}
+	return clones.front();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TFunctor>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::parallelForEachValue(const QVector<ParallelTask> &tasks, const NodeData *skipped, TFunctor &&functor)
+{
+	// the largest tasks are started first, so the small ones fill the gaps at the end
+	std::vector<int> order(static_cast<std::size_t>(tasks.size()));
+	std::iota(order.begin(), order.end(), 0);
+	const auto taskSize = [&tasks](int index) {
+		return tasks[index].withChildren ? tasks[index].node->subtreeNodes : 1;
+	};
+	std::stable_sort(order.begin(), order.end(), [&taskSize](int lhs, int rhs) {
+		return taskSize(lhs) > taskSize(rhs);
+	});
+
+	QGenericTreeParallelRunner::run(tasks.size(), [&](int index) {
+		const auto taskIndex = order[static_cast<std::size_t>(index)];
+		const auto &task = tasks[taskIndex];
+		const auto visit = [&](NodeData *node) {
+			if (node != skipped && node->value)
+				functor(taskIndex, *node->value);
+		};
+		if (task.withChildren)
+			task.node->forEachNode(visit);
+		else
+			visit(task.node);
+	});
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TMapFunctor, typename TReduceFunctor, typename TResult>
+TResult QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::parallelReduceValues(NodeData *root, const NodeData *skipped, TMapFunctor &mapFunctor, TReduceFunctor &reduceFunctor, TResult initial)
+{
+	// every task reduces its values into its own partial result, and the tasks are in preorder
+	const auto tasks = splitTasks(root);
+	std::vector<std::optional<TResult>> partials(static_cast<std::size_t>(tasks.size()));
+	parallelForEachValue(tasks, skipped, [&](int taskIndex, const TValue &value) {
+		auto &partial = partials[static_cast<std::size_t>(taskIndex)];
+		if (partial)
+			reduceFunctor(*partial, mapFunctor(value));
+		else
+			partial = mapFunctor(value);
+	});
+	for (const auto &partial : partials) {
+		if (partial)
+			reduceFunctor(initial, *partial);
+	}
+	return initial;
+}
+
+
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::NodeData(const TAllocator &allocator, ParentPtr parent, TKey subKey) :
+	TAllocator{allocator},
+	parent{std::move(parent)},
+	subKey{std::move(subKey)}
+{}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename... TArgs>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodePtr QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::create(const TAllocator &allocator, TArgs&&... args)
+{
+	return TPointerPolicy::template create<NodeData>(allocator, allocator, std::forward<TArgs>(args)...);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+const typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodePtr &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::appendChild(const NodePtr &parent, const TKey &key)
+{
+	return appendChild(parent, key, create(parent->allocator(), TPointerPolicy::toParent(parent), key));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+const typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodePtr &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::appendChild(const NodePtr &parent, const TKey &key, NodePtr child)
+{
+	// appends a child that is known to be the last one, with an end hint if the container supports it.
+	// The counters of the parent are left to the caller.
+	if constexpr (QGenericTreeHasInsertHint<Container>::value)
+		return *parent->children.insert(parent->children.constEnd(), key, std::move(child));
+	else
+		return *parent->children.insert(key, std::move(child));
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::~NodeData()
+{
+	// raw parent pointers of children that outlive me must not dangle
+	if constexpr (std::is_pointer_v<ParentPtr>) {
+		for (const auto &child : qAsConst(children))
+			child->orphan();
+	}
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline const TAllocator &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::allocator() const
+{
+	return *this;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::Lock &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::lock() const
+{
+	return const_cast<NodeData&>(*this);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodePtr QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::lockParent() const
+{
+	const ReadLocker locker{this};
+	return TPointerPolicy::toPointer(parent);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TIterator>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodePtr QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::find(TIterator begin, TIterator end, const NodePtr &current) {
+	// walk references into the child containers, so only the result is copied. With locks, the
+	// references are only valid while the parent is locked, so every level has to be copied.
+	if constexpr (TLockPolicy::IsLocking) {
+		auto node = current;
+		for (; begin != end; ++begin) {
+			const ReadLocker locker{&*node};
+			const auto it = node->children.constFind(*begin);
+			if (it == node->children.constEnd())
+				return NodePtr{};
+			node = *it;
+		}
+		return node;
+	} else {
+		auto node = &current;
+		for (; begin != end; ++begin) {
+			const auto &children = (*node)->children;
+			const auto it = children.constFind(*begin);
+			if (it == children.constEnd())
+				return NodePtr{};
+			node = &*it;
+		}
+		return *node;
+	}
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodePtr QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::clone(const TAllocator &allocator, ParentPtr parent, const TKey &subKey) const {
+	// the children are cloned straight into an empty container in their order, instead of copying the container and replacing every entry afterwards
+	auto cloned = create(allocator, std::move(parent), subKey);
+	cloned->value = value;
+	cloned->subtreeNodes = subtreeNodes;
+	cloned->subtreeValues = subtreeValues;
+	if constexpr (QGenericTreeHasReserve<Container>::value)
+		cloned->children.reserve(children.size());
+	const auto clonedParent = TPointerPolicy::toParent(cloned);
+	for (auto it = children.cbegin(), end = children.cend(); it != end; ++it)
+		appendChild(cloned, it.key(), (*it)->clone(allocator, clonedParent, it.key()));
+	return cloned;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+int QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::depth() const
+{
+	const auto strParent = lockParent();
+	return strParent ? strParent->depth() + 1 : 0;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+QList<TKey> QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::key() const
+{
+	const auto strParent = lockParent();
+	if (!strParent)
+		return {};
+
+	auto keyChain = strParent->key();
+	const ReadLocker locker{this};
+	keyChain.append(subKey);
+	return keyChain;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+template <typename TFunctor>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::forEachNode(TFunctor &functor)
+{
+	// preorder with the remaining children of every level on a stack, so deep trees cannot overflow the call stack
+	using ChildIterator = typename Container::const_iterator;
+	QVarLengthArray<std::pair<ChildIterator, ChildIterator>, 16> path;
+	functor(this);
+	path.append({children.cbegin(), children.cend()});
+	while (!path.isEmpty()) {
+		auto &level = path.last();
+		if (level.first == level.second) {
+			path.removeLast();
+			continue;
+		}
+
+		const auto node = &**level.first++;
+		functor(node);
+		path.append({node->children.cbegin(), node->children.cend()});
+	}
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::insertChild(const NodePtr &child)
+{
+	// replaced children are orphaned so they do not report a stale parent or key
+	int nodes = child->subtreeNodes;
+	int values = child->subtreeValues;
+	{
+		const WriteLocker locker{this};
+		auto dIter = children.find(child->subKey);
+		if (dIter != children.end()) {
+			nodes -= (*dIter)->subtreeNodes;
+			values -= (*dIter)->subtreeValues;
+			(*dIter)->orphan();
+			*dIter = child;
+		} else
+			children.insert(child->subKey, child);
+	}
+	updateCounts(nodes, values);
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::orphan()
+{
+	const WriteLocker locker{this};
+	parent = nullptr;
+	subKey = TKey{};
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::updateCounts(int nodes, int values)
+{
+	if (nodes == 0 && values == 0)
+		return;
+
+	subtreeNodes += nodes;
+	subtreeValues += values;
+	for (auto node = lockParent(); node; node = node->lockParent()) {
+		node->subtreeNodes += nodes;
+		node->subtreeValues += values;
+	}
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeData::valueChanged(bool hadValue, bool hasValue)
+{
+	if (hadValue != hasValue)
+		updateCounts(0, hadValue ? -1 : 1);
+}
+
+
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ReadLocker::ReadLocker(const NodeData *node) :
+	_lock{node->lock()}
+{
+	_lock.lockForRead();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::ReadLocker::~ReadLocker()
+{
+	_lock.unlock();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::WriteLocker::WriteLocker(const NodeData *node) :
+	_lock{node->lock()}
+{
+	_lock.lockForWrite();
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::WriteLocker::~WriteLocker()
+{
+	_lock.unlock();
+}
+
+
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline bool QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeQueue::isEmpty() const
+{
+	return _size == 0;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline const typename QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodePtr &QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeQueue::first() const
+{
+	return *_buffer[_head];
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeQueue::enqueue(const NodePtr *node)
+{
+	if (_size == _buffer.size()) {
+		// unwrap into a buffer of twice the size, so the capacity stays a power of two
+		QVector<const NodePtr*> buffer(qMax(16, _size * 2));
+		for (auto i = 0; i < _size; ++i)
+			buffer[i] = _buffer[(_head + i) & (_buffer.size() - 1)];
+		_buffer = std::move(buffer);
+		_head = 0;
+	}
+	_buffer[(_head + _size) & (_buffer.size() - 1)] = node;
+	++_size;
+}
+
+template <typename TKey, typename TValue, template<class, class> typename TContainer, typename TAllocator, typename TPointerPolicy, typename TLockPolicy>
+inline void QGenericTreeBase<TKey, TValue, TContainer, TAllocator, TPointerPolicy, TLockPolicy>::NodeQueue::dequeue()
+{
+	_head = (_head + 1) & (_buffer.size() - 1);
+	--_size;
+}
+
+
+
+template <typename TKey>
+constexpr QGenericTreeKeySpan<TKey>::QGenericTreeKeySpan(const TKey *data, int size) :
+	_data{data},
+	_size{size}
+{}
+
+template <typename TKey>
+constexpr QGenericTreeKeySpan<TKey>::QGenericTreeKeySpan(std::initializer_list<TKey> keys) :
+	_data{keys.begin()},
+	_size{static_cast<int>(keys.size())}
+{}
+
+template <typename TKey>
+template <typename TKeyContainer, typename>
+constexpr QGenericTreeKeySpan<TKey>::QGenericTreeKeySpan(const TKeyContainer &keys) :
+	_data{std::data(keys)},
+	_size{static_cast<int>(std::size(keys))}
+{}
+
+template <typename TKey>
+constexpr const TKey *QGenericTreeKeySpan<TKey>::data() const
+{
+	return _data;
+}
+
+template <typename TKey>
+constexpr int QGenericTreeKeySpan<TKey>::size() const
+{
+	return _size;
+}
+
+template <typename TKey>
+constexpr bool QGenericTreeKeySpan<TKey>::isEmpty() const
+{
+	return _size == 0;
+}
+
+template <typename TKey>
+constexpr const TKey &QGenericTreeKeySpan<TKey>::operator[](int index) const
+{
+	return _data[index];
+}
+
+template <typename TKey>
+constexpr typename QGenericTreeKeySpan<TKey>::const_iterator QGenericTreeKeySpan<TKey>::begin() const
+{
+	return _data;
+}
+
+template <typename TKey>
+constexpr typename QGenericTreeKeySpan<TKey>::const_iterator QGenericTreeKeySpan<TKey>::end() const
+{
+	return _data + _size;
+}
+
+
+
+template <typename T, typename TAllocator, typename... TArgs>
+inline QGenericTreeSharedPointerPolicy::Pointer<T> QGenericTreeSharedPointerPolicy::create(const TAllocator &allocator, TArgs&&... args)
+{
+	// create allocates the data and the refcount block at once
+	static_assert(std::is_same_v<TAllocator, QGenericTreeHeapAllocator>, "QSharedPointer needs a separate control block for custom allocators. Use QGenericTreeIntrusivePointerPolicy instead.");
+	Q_UNUSED(allocator)
+	return Pointer<T>::create(std::forward<TArgs>(args)...);
+}
+
+template <typename T>
+inline QGenericTreeSharedPointerPolicy::Pointer<T> QGenericTreeSharedPointerPolicy::toPointer(const ParentPointer<T> &parent)
+{
+	return parent.toStrongRef();
+}
+
+template <typename T>
+inline QGenericTreeSharedPointerPolicy::ParentPointer<T> QGenericTreeSharedPointerPolicy::toParent(const Pointer<T> &pointer)
+{
+	return pointer.toWeakRef();
+}
+
+
+
+inline void QGenericTreeParallelRunner::run(int taskCount, const std::function<void(int)> &task)
+{
+	std::atomic<int> next{0};
+	const auto pool = QThreadPool::globalInstance();
+	const auto helperCount = qMin(taskCount, pool->maxThreadCount()) - 1;
+	QSemaphore done;
+	std::vector<std::unique_ptr<Worker>> helpers;
+	helpers.reserve(static_cast<std::size_t>(qMax(helperCount, 0)));
+	for (auto i = 0; i < helperCount; ++i) {
+		helpers.push_back(std::make_unique<Worker>(next, taskCount, task, &done));
+		helpers.back()->setAutoDelete(false);
+		pool->start(helpers.back().get());
+	}
+
+	Worker{next, taskCount, task}.work();
+	// helpers that did not get a thread yet are taken back, so a busy pool never blocks me, e.g. when called from a pool thread
+	auto pending = static_cast<int>(helpers.size());
+	for (const auto &helper : helpers) {
+		if (pool->tryTake(helper.get()))
+			--pending;
+	}
+	done.acquire(pending);
+}
+
+inline QGenericTreeParallelRunner::Worker::Worker(std::atomic<int> &next, int taskCount, const std::function<void(int)> &task, QSemaphore *done) :
+	_next{next},
+	_taskCount{taskCount},
+	_task{task},
+	_done{done}
+{}
+
+inline void QGenericTreeParallelRunner::Worker::run()
+{
+	work();
+	_done->release();
+}
+
+inline void QGenericTreeParallelRunner::Worker::work()
+{
+	for (auto index = _next++; index < _taskCount; index = _next++)
+		_task(index);
+}
+
+
+
+template <typename TKey, typename TValue, template<class, class> class TContainer, typename... TPolicies>
+QDataStream &operator<<(QDataStream &stream, const QGenericTreeBase<TKey, TValue, TContainer, TPolicies...> &tree)
+{
+	tree.writeTo(stream);
+	return stream;
+}
+
+template <typename TKey, typename TValue, template<class, class> class TContainer, typename... TPolicies>
+QDataStream &operator>>(QDataStream &stream, QGenericTreeBase<TKey, TValue, TContainer, TPolicies...> &tree)
+{
+	tree = QGenericTreeBase<TKey, TValue, TContainer, TPolicies...>::readFrom(stream);
+	return stream;
+}
+
+
+
+inline QGenericTreeAtomicCounter::QGenericTreeAtomicCounter(int value) :
+	_value{value}
+{}
+
+inline QGenericTreeAtomicCounter::QGenericTreeAtomicCounter(const QGenericTreeAtomicCounter &other) :
+	_value{other._value.load(std::memory_order_relaxed)}
+{}
+
+inline QGenericTreeAtomicCounter &QGenericTreeAtomicCounter::operator=(const QGenericTreeAtomicCounter &other)
+{
+	_value.store(other._value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	return *this;
+}
+
+inline QGenericTreeAtomicCounter::operator int() const
+{
+	return _value.load(std::memory_order_relaxed);
+}
+
+inline QGenericTreeAtomicCounter &QGenericTreeAtomicCounter::operator+=(int value)
+{
+	_value.fetch_add(value, std::memory_order_relaxed);
+	return *this;
+}
+
+inline QGenericTreeAtomicCounter &QGenericTreeAtomicCounter::operator-=(int value)
+{
+	_value.fetch_sub(value, std::memory_order_relaxed);
+	return *this;
+}
+
+inline QGenericTreeAtomicCounter &QGenericTreeAtomicCounter::operator++()
+{
+	_value.fetch_add(1, std::memory_order_relaxed);
+	return *this;
+}
+
+
+
+inline void QGenericTreeNoLockPolicy::Lock::lockForRead() {}
+
+inline void QGenericTreeNoLockPolicy::Lock::lockForWrite() {}
+
+inline void QGenericTreeNoLockPolicy::Lock::unlock() {}
+
+
+
+inline void *QGenericTreeHeapAllocator::allocate(std::size_t size, std::size_t alignment) const
+{
+	Q_UNUSED(alignment)
+	return ::operator new(size);
+}
+
+inline void QGenericTreeHeapAllocator::deallocate(void *ptr, std::size_t size, std::size_t alignment) const
+{
+	Q_UNUSED(size)
+	Q_UNUSED(alignment)
+	::operator delete(ptr);
 }
 
 #endif // QGENERICTREEBASE_H
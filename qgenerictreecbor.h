@@ -0,0 +1,828 @@
+#ifndef QGENERICTREECBOR_H
+#define QGENERICTREECBOR_H
+
+#include "qgenerictreebase.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QCborStreamReader>
+#include <QtCore/QCborStreamWriter>
+#include <QtCore/QCborValue>
+#include <QtCore/QIODevice>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonValue>
+#include <QtCore/QList>
+#include <QtCore/QLocale>
+#include <QtCore/QString>
+#include <QtCore/QVarLengthArray>
+#include <QtCore/QVariant>
+
+// Streaming conversion between trees and CBOR or JSON documents, without building a QCborValue or
+// QJsonDocument of the whole document first. Only the open maps of the current path are kept, so the
+// extra memory depends on the depth of the document, not its size.
+// Maps become child nodes and scalars become values. A node that has children as well as a value stores
+// its value under the empty string key, nodes without either are null, and arrays are read as children
+// keyed by their index. Child keys that are written as strings of backslashes only, including the empty
+// one, get one more backslash, so they cannot be mistaken for the value key. Keys and values are
+// converted through QVariant, with shortcuts for integers, floating point numbers, booleans and strings.
+class QGenericTreeCbor
+{
+public:
+	template <typename TTree>
+	static void writeCbor(QCborStreamWriter &writer, const TTree &tree);
+	template <typename TTree>
+	static bool readCbor(QCborStreamReader &reader, TTree &tree);
+
+	template <typename TTree>
+	static bool writeJson(QIODevice *device, const TTree &tree);
+	template <typename TTree>
+	static bool readJson(QIODevice *device, TTree &tree);
+
+private:
+	template <typename TTree>
+	struct TreeTypes;
+	template <typename TKey, typename TValue, template<class, class> class TContainer, typename... TPolicies>
+	struct TreeTypes<QGenericTreeBase<TKey, TValue, TContainer, TPolicies...>> {
+		using Key = TKey;
+		using Value = TValue;
+	};
+
+	// builds a tree from the events of a reader. Every element of a map or array is read into the target
+	// node, which is either a child of the innermost open container or, for the value key, the container
+	template <typename TTree>
+	class Builder
+	{
+	public:
+		using Node = typename TTree::Node;
+
+		inline explicit Builder(TTree &tree);
+
+		inline int depth() const;
+		inline bool inArray() const;
+		inline int elementCount() const;
+
+		bool key(const QCborValue &key);
+		bool nextIndex();
+		inline void beginMap();
+		inline void beginArray();
+		inline void end();
+		void value(const QCborValue &value);
+
+	private:
+		struct Level {
+			Node node;
+			bool isArray;
+			int elements;
+		};
+
+		QVarLengthArray<Level, 16> _levels;
+		Node _target;
+	};
+
+	class CborVisitor
+	{
+	public:
+		inline explicit CborVisitor(QCborStreamWriter &writer);
+
+		inline void beginMap(int size);
+		inline void endMap();
+		inline void valueKey();
+		template <typename TKey>
+		void key(const TKey &key);
+		template <typename TValue>
+		void value(const TValue &value);
+		inline void null();
+
+	private:
+		QCborStreamWriter &_writer;
+	};
+
+	// writes into a buffer that is flushed to the device whenever it gets large
+	class JsonVisitor
+	{
+	public:
+		inline explicit JsonVisitor(QIODevice *device);
+
+		inline void beginMap(int size);
+		inline void endMap();
+		inline void valueKey();
+		template <typename TKey>
+		void key(const TKey &key);
+		template <typename TValue>
+		void value(const TValue &value);
+		inline void null();
+		inline bool flush();
+
+	private:
+		static constexpr int FlushSize = 64 * 1024;
+
+		QIODevice *_device;
+		QByteArray _buffer;
+		bool _needsComma = false;
+		bool _ok = true;
+
+		inline void separate();
+		inline void appendString(const QString &string);
+		inline void appendNumber(double number);
+		inline void appendJson(const QJsonValue &value);
+		inline void written();
+	};
+
+	// a pull parser that reads one token at a time
+	class JsonReader
+	{
+	public:
+		inline explicit JsonReader(QIODevice *device);
+
+		inline bool nextToken(char &c);
+		inline bool readString(QString &string);
+		inline bool readLiteral(char first, QCborValue &value);
+
+	private:
+		QIODevice *_device;
+		QByteArray _chunk; // reused for every string and literal
+	};
+
+	template <typename TTree, typename TVisitor>
+	static void walk(const TTree &tree, TVisitor &visitor);
+	static inline bool isBackslashesOnly(const QString &key);
+	static inline QString escapeKey(QString key);
+	template <typename TKey>
+	static bool toKey(const QCborValue &cbor, TKey &key);
+	template <typename TValue>
+	static TValue toValue(const QCborValue &cbor);
+	template <typename TTree>
+	static bool readJsonElement(JsonReader &reader, Builder<TTree> &builder, char c);
+};
+
+// GENERIC IMPLEMENTATION
+
+template <typename TTree>
+void QGenericTreeCbor::writeCbor(QCborStreamWriter &writer, const TTree &tree)
+{
+	CborVisitor visitor{writer};
+	walk(tree, visitor);
+}
+
+template <typename TTree>
+bool QGenericTreeCbor::readCbor(QCborStreamReader &reader, TTree &tree)
+{
+	TTree result;
+	Builder<TTree> builder{result};
+	const auto readElement = [&reader, &builder]() {
+		if (reader.isMap()) {
+			builder.beginMap();
+			return reader.enterContainer();
+		} else if (reader.isArray()) {
+			builder.beginArray();
+			return reader.enterContainer();
+		} else {
+			builder.value(QCborValue::fromCbor(reader));
+			return reader.lastError() == QCborError::NoError;
+		}
+	};
+
+	auto ok = readElement();
+	while (ok && builder.depth() > 0) {
+		if (!reader.hasNext()) {
+			ok = reader.leaveContainer();
+			builder.end();
+		} else if (builder.inArray()) {
+			ok = builder.nextIndex() && readElement();
+		} else if (reader.isMap() || reader.isArray()) {
+			ok = false; // keys must be scalars
+		} else {
+			const auto key = QCborValue::fromCbor(reader);
+			ok = reader.lastError() == QCborError::NoError &&
+				builder.key(key) &&
+				readElement();
+		}
+	}
+
+	if (!ok || reader.lastError() != QCborError::NoError)
+		return false;
+	tree = std::move(result);
+	return true;
+}
+
+template <typename TTree>
+bool QGenericTreeCbor::writeJson(QIODevice *device, const TTree &tree)
+{
+	JsonVisitor visitor{device};
+	walk(tree, visitor);
+	return visitor.flush();
+}
+
+template <typename TTree>
+bool QGenericTreeCbor::readJson(QIODevice *device, TTree &tree)
+{
+	TTree result;
+	Builder<TTree> builder{result};
+	JsonReader reader{device};
+
+	char c;
+	if (!reader.nextToken(c) || !readJsonElement(reader, builder, c))
+		return false;
+	while (builder.depth() > 0) {
+		if (!reader.nextToken(c))
+			return false;
+		if (c == (builder.inArray() ? ']' : '}')) {
+			builder.end();
+			continue;
+		}
+		if (builder.elementCount() > 0) {
+			if (c != ',' || !reader.nextToken(c))
+				return false;
+		}
+
+		if (builder.inArray()) {
+			if (!builder.nextIndex())
+				return false;
+		} else {
+			QString key;
+			if (c != '"' ||
+				!reader.readString(key) ||
+				!reader.nextToken(c) ||
+				c != ':' ||
+				!builder.key(QCborValue{key}) ||
+				!reader.nextToken(c))
+				return false;
+		}
+		if (!readJsonElement(reader, builder, c))
+			return false;
+	}
+
+	// only whitespace may follow the document
+	if (reader.nextToken(c))
+		return false;
+	tree = std::move(result);
+	return true;
+}
+
+template <typename TTree, typename TVisitor>
+void QGenericTreeCbor::walk(const TTree &tree, TVisitor &visitor)
+{
+	// preorder over the nodes, with the children of the open maps as a path like QGenericTreeBase::writeTo.
+	// The nodes are read through their public API, which takes the read locks of the lock policy.
+	using Node = typename TTree::ConstNode;
+	struct Level {
+		QList<Node> children;
+		int next = 0;
+	};
+	QVarLengthArray<Level, 16> path;
+	const auto visitNode = [&visitor, &path](const Node &node) {
+		auto children = node.children();
+		const auto hasValue = node.hasValue();
+		if (children.isEmpty()) {
+			if (hasValue)
+				visitor.value(*node);
+			else
+				visitor.null();
+			return;
+		}
+
+		visitor.beginMap(children.size() + (hasValue ? 1 : 0));
+		if (hasValue) {
+			visitor.valueKey();
+			visitor.value(*node);
+		}
+		path.append(Level{std::move(children)});
+	};
+
+	visitNode(tree.rootNode());
+	while (!path.isEmpty()) {
+		auto &level = path.last();
+		if (level.next == level.children.size()) {
+			path.removeLast();
+			visitor.endMap();
+			continue;
+		}
+
+		// a copy, as visiting it may add a level
+		const auto child = level.children[level.next++];
+		visitor.key(child.subKey());
+		visitNode(child);
+	}
+}
+
+bool QGenericTreeCbor::isBackslashesOnly(const QString &key)
+{
+	return std::all_of(key.cbegin(), key.cend(), [](QChar c) {
+		return c == QLatin1Char('\\');
+	});
+}
+
+QString QGenericTreeCbor::escapeKey(QString key)
+{
+	if (isBackslashesOnly(key))
+		key.append(QLatin1Char('\\'));
+	return key;
+}
+
+template <typename TKey>
+bool QGenericTreeCbor::toKey(const QCborValue &cbor, TKey &key)
+{
+	if constexpr (std::is_integral_v<TKey> && !std::is_same_v<TKey, bool>) {
+		if (cbor.isInteger()) {
+			key = static_cast<TKey>(cbor.toInteger());
+			return true;
+		} else if (cbor.isString()) {
+			auto ok = false;
+			key = static_cast<TKey>(cbor.toString().toLongLong(&ok));
+			return ok;
+		} else
+			return false;
+	} else if constexpr (std::is_same_v<TKey, QString>) {
+		if (cbor.isString())
+			key = cbor.toString();
+		else if (cbor.isInteger())
+			key = QString::number(cbor.toInteger());
+		else
+			return false;
+		return true;
+	} else {
+		const auto variant = cbor.toVariant();
+		if (!variant.canConvert<TKey>())
+			return false;
+		key = qvariant_cast<TKey>(variant);
+		return true;
+	}
+}
+
+template <typename TValue>
+TValue QGenericTreeCbor::toValue(const QCborValue &cbor)
+{
+	if constexpr (std::is_same_v<TValue, QCborValue>)
+		return cbor;
+	else if constexpr (std::is_same_v<TValue, QString>)
+		return cbor.isString() ? cbor.toString() : cbor.toVariant().toString();
+	else if constexpr (std::is_same_v<TValue, bool>)
+		return cbor.toBool();
+	else if constexpr (std::is_integral_v<TValue>)
+		return static_cast<TValue>(cbor.isDouble() ? static_cast<qint64>(cbor.toDouble()) : cbor.toInteger());
+	else if constexpr (std::is_floating_point_v<TValue>)
+		return static_cast<TValue>(cbor.toDouble());
+	else
+		return qvariant_cast<TValue>(cbor.toVariant());
+}
+
+template <typename TTree>
+bool QGenericTreeCbor::readJsonElement(JsonReader &reader, Builder<TTree> &builder, char c)
+{
+	switch (c) {
+	case '{':
+		builder.beginMap();
+		return true;
+	case '[':
+		builder.beginArray();
+		return true;
+	case '"': {
+		QString string;
+		if (!reader.readString(string))
+			return false;
+		builder.value(QCborValue{string});
+		return true;
+	}
+	default: {
+		QCborValue value;
+		if (!reader.readLiteral(c, value))
+			return false;
+		builder.value(value);
+		return true;
+	}
+	}
+}
+
+
+
+template <typename TTree>
+QGenericTreeCbor::Builder<TTree>::Builder(TTree &tree) :
+	_target{tree.rootNode()}
+{}
+
+template <typename TTree>
+int QGenericTreeCbor::Builder<TTree>::depth() const
+{
+	return _levels.size();
+}
+
+template <typename TTree>
+bool QGenericTreeCbor::Builder<TTree>::inArray() const
+{
+	return _levels.last().isArray;
+}
+
+template <typename TTree>
+int QGenericTreeCbor::Builder<TTree>::elementCount() const
+{
+	return _levels.last().elements;
+}
+
+template <typename TTree>
+bool QGenericTreeCbor::Builder<TTree>::key(const QCborValue &key)
+{
+	auto &level = _levels.last();
+	++level.elements;
+	auto childKey = key;
+	if (key.isString()) {
+		auto string = key.toString();
+		if (string.isEmpty()) {
+			_target = level.node;
+			return true;
+		}
+		// escaped child keys lose the backslash that was added when writing
+		if (isBackslashesOnly(string)) {
+			string.chop(1);
+			childKey = QCborValue{string};
+		}
+	}
+
+	typename TreeTypes<TTree>::Key subKey;
+	if (!toKey(childKey, subKey))
+		return false;
+	_target = level.node[subKey];
+	return true;
+}
+
+template <typename TTree>
+bool QGenericTreeCbor::Builder<TTree>::nextIndex()
+{
+	// arrays can only be read into trees with keys that can be created from an index
+	auto &level = _levels.last();
+	typename TreeTypes<TTree>::Key subKey;
+	if (!toKey(QCborValue{static_cast<qint64>(level.elements++)}, subKey))
+		return false;
+	_target = level.node[subKey];
+	return true;
+}
+
+template <typename TTree>
+void QGenericTreeCbor::Builder<TTree>::beginMap()
+{
+	_levels.append({_target, false, 0});
+}
+
+template <typename TTree>
+void QGenericTreeCbor::Builder<TTree>::beginArray()
+{
+	_levels.append({_target, true, 0});
+}
+
+template <typename TTree>
+void QGenericTreeCbor::Builder<TTree>::end()
+{
+	_levels.removeLast();
+}
+
+template <typename TTree>
+void QGenericTreeCbor::Builder<TTree>::value(const QCborValue &value)
+{
+	if (!value.isNull() && !value.isUndefined())
+		_target.setValue(toValue<typename TreeTypes<TTree>::Value>(value));
+}
+
+
+
+QGenericTreeCbor::CborVisitor::CborVisitor(QCborStreamWriter &writer) :
+	_writer{writer}
+{}
+
+void QGenericTreeCbor::CborVisitor::beginMap(int size)
+{
+	_writer.startMap(static_cast<quint64>(size));
+}
+
+void QGenericTreeCbor::CborVisitor::endMap()
+{
+	_writer.endMap();
+}
+
+void QGenericTreeCbor::CborVisitor::valueKey()
+{
+	_writer.append(QLatin1String{""});
+}
+
+template <typename TKey>
+void QGenericTreeCbor::CborVisitor::key(const TKey &key)
+{
+	if constexpr (std::is_same_v<TKey, QString>)
+		_writer.append(escapeKey(key));
+	else if constexpr (std::is_arithmetic_v<TKey> || std::is_same_v<TKey, QByteArray>)
+		value(key);
+	else {
+		// other types might still become strings
+		auto cbor = QCborValue::fromVariant(QVariant::fromValue(key));
+		if (cbor.isString())
+			cbor = QCborValue{escapeKey(cbor.toString())};
+		cbor.toCbor(_writer);
+	}
+}
+
+template <typename TValue>
+void QGenericTreeCbor::CborVisitor::value(const TValue &value)
+{
+	if constexpr (std::is_same_v<TValue, bool>)
+		_writer.append(value);
+	else if constexpr (std::is_integral_v<TValue> && std::is_signed_v<TValue>)
+		_writer.append(static_cast<qint64>(value));
+	else if constexpr (std::is_integral_v<TValue>)
+		_writer.append(static_cast<quint64>(value));
+	else if constexpr (std::is_floating_point_v<TValue>)
+		_writer.append(static_cast<double>(value));
+	else if constexpr (std::is_same_v<TValue, QString> || std::is_same_v<TValue, QByteArray>)
+		_writer.append(value);
+	else if constexpr (std::is_same_v<TValue, QCborValue>)
+		value.toCbor(_writer);
+	else
+		QCborValue::fromVariant(QVariant::fromValue(value)).toCbor(_writer);
+}
+
+void QGenericTreeCbor::CborVisitor::null()
+{
+	_writer.append(nullptr);
+}
+
+
+
+QGenericTreeCbor::JsonVisitor::JsonVisitor(QIODevice *device) :
+	_device{device}
+{
+	_buffer.reserve(FlushSize + 1024);
+}
+
+void QGenericTreeCbor::JsonVisitor::beginMap(int size)
+{
+	Q_UNUSED(size)
+	_buffer.append('{');
+	_needsComma = false;
+}
+
+void QGenericTreeCbor::JsonVisitor::endMap()
+{
+	_buffer.append('}');
+	written();
+}
+
+void QGenericTreeCbor::JsonVisitor::valueKey()
+{
+	separate();
+	_buffer.append("\"\":");
+}
+
+template <typename TKey>
+void QGenericTreeCbor::JsonVisitor::key(const TKey &key)
+{
+	separate();
+	if constexpr (std::is_integral_v<TKey> && !std::is_same_v<TKey, bool>) {
+		_buffer.append('"');
+		_buffer.append(QByteArray::number(static_cast<qint64>(key)));
+		_buffer.append('"');
+	} else if constexpr (std::is_same_v<TKey, QString>)
+		appendString(escapeKey(key));
+	else
+		appendString(escapeKey(QVariant::fromValue(key).toString()));
+	_buffer.append(':');
+}
+
+template <typename TValue>
+void QGenericTreeCbor::JsonVisitor::value(const TValue &value)
+{
+	if constexpr (std::is_same_v<TValue, bool>)
+		_buffer.append(value ? "true" : "false");
+	else if constexpr (std::is_integral_v<TValue> && std::is_signed_v<TValue>)
+		_buffer.append(QByteArray::number(static_cast<qint64>(value)));
+	else if constexpr (std::is_integral_v<TValue>)
+		_buffer.append(QByteArray::number(static_cast<quint64>(value)));
+	else if constexpr (std::is_floating_point_v<TValue>)
+		appendNumber(static_cast<double>(value));
+	else if constexpr (std::is_same_v<TValue, QString>)
+		appendString(value);
+	else if constexpr (std::is_same_v<TValue, QCborValue>)
+		appendJson(value.toJsonValue());
+	else
+		appendJson(QJsonValue::fromVariant(QVariant::fromValue(value)));
+	written();
+}
+
+void QGenericTreeCbor::JsonVisitor::null()
+{
+	_buffer.append("null");
+	written();
+}
+
+bool QGenericTreeCbor::JsonVisitor::flush()
+{
+	if (_ok && !_buffer.isEmpty())
+		_ok = _device->write(_buffer) == _buffer.size();
+	_buffer.clear();
+	return _ok;
+}
+
+void QGenericTreeCbor::JsonVisitor::separate()
+{
+	if (_needsComma)
+		_buffer.append(',');
+}
+
+void QGenericTreeCbor::JsonVisitor::appendString(const QString &string)
+{
+	static constexpr char Hex[] = "0123456789abcdef";
+	_buffer.append('"');
+	for (const auto c : string.toUtf8()) {
+		switch (c) {
+		case '"':
+			_buffer.append("\\\"");
+			break;
+		case '\\':
+			_buffer.append("\\\\");
+			break;
+		case '\b':
+			_buffer.append("\\b");
+			break;
+		case '\f':
+			_buffer.append("\\f");
+			break;
+		case '\n':
+			_buffer.append("\\n");
+			break;
+		case '\r':
+			_buffer.append("\\r");
+			break;
+		case '\t':
+			_buffer.append("\\t");
+			break;
+		default:
+			if (c >= 0 && c < 0x20) {
+				_buffer.append("\\u00");
+				_buffer.append(Hex[c >> 4]);
+				_buffer.append(Hex[c & 0xf]);
+			} else
+				_buffer.append(c);
+			break;
+		}
+	}
+	_buffer.append('"');
+}
+
+void QGenericTreeCbor::JsonVisitor::appendNumber(double number)
+{
+	// like QJsonDocument, infinite numbers and NaN become null
+	if (std::isfinite(number))
+		_buffer.append(QByteArray::number(number, 'g', QLocale::FloatingPointShortest));
+	else
+		_buffer.append("null");
+}
+
+void QGenericTreeCbor::JsonVisitor::appendJson(const QJsonValue &value)
+{
+	switch (value.type()) {
+	case QJsonValue::Bool:
+		_buffer.append(value.toBool() ? "true" : "false");
+		break;
+	case QJsonValue::Double:
+		appendNumber(value.toDouble());
+		break;
+	case QJsonValue::String:
+		appendString(value.toString());
+		break;
+	case QJsonValue::Array:
+		_buffer.append(QJsonDocument{value.toArray()}.toJson(QJsonDocument::Compact));
+		break;
+	case QJsonValue::Object:
+		_buffer.append(QJsonDocument{value.toObject()}.toJson(QJsonDocument::Compact));
+		break;
+	case QJsonValue::Null:
+	case QJsonValue::Undefined:
+		_buffer.append("null");
+		break;
+	}
+}
+
+void QGenericTreeCbor::JsonVisitor::written()
+{
+	_needsComma = true;
+	if (_buffer.size() >= FlushSize)
+		flush();
+}
+
+
+
+QGenericTreeCbor::JsonReader::JsonReader(QIODevice *device) :
+	_device{device}
+{}
+
+bool QGenericTreeCbor::JsonReader::nextToken(char &c)
+{
+	while (_device->getChar(&c)) {
+		if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+			return true;
+	}
+	return false;
+}
+
+bool QGenericTreeCbor::JsonReader::readString(QString &string)
+{
+	// plain runs are collected as UTF-8 and converted at once, escapes are appended as UTF-16 units,
+	// which also combines escaped surrogate pairs
+	string.clear();
+	_chunk.clear();
+	char c;
+	while (_device->getChar(&c)) {
+		if (c == '"') {
+			string.append(QString::fromUtf8(_chunk));
+			return true;
+		} else if (c >= 0 && c < 0x20)
+			return false;
+		else if (c != '\\') {
+			_chunk.append(c);
+			continue;
+		}
+
+		string.append(QString::fromUtf8(_chunk));
+		_chunk.clear();
+		if (!_device->getChar(&c))
+			return false;
+		switch (c) {
+		case '"':
+		case '\\':
+		case '/':
+			string.append(QLatin1Char{c});
+			break;
+		case 'b':
+			string.append(QLatin1Char{'\b'});
+			break;
+		case 'f':
+			string.append(QLatin1Char{'\f'});
+			break;
+		case 'n':
+			string.append(QLatin1Char{'\n'});
+			break;
+		case 'r':
+			string.append(QLatin1Char{'\r'});
+			break;
+		case 't':
+			string.append(QLatin1Char{'\t'});
+			break;
+		case 'u': {
+			char hex[4];
+			if (_device->read(hex, sizeof(hex)) != sizeof(hex))
+				return false;
+			auto ok = false;
+			const auto unit = QByteArray::fromRawData(hex, sizeof(hex)).toUShort(&ok, 16);
+			if (!ok)
+				return false;
+			string.append(QChar{unit});
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+	return false;
+}
+
+bool QGenericTreeCbor::JsonReader::readLiteral(char first, QCborValue &value)
+{
+	_chunk.clear();
+	_chunk.append(first);
+	char c;
+	while (_device->getChar(&c)) {
+		if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E') {
+			_chunk.append(c);
+		} else {
+			_device->ungetChar(c);
+			break;
+		}
+	}
+
+	if (_chunk == "true")
+		value = QCborValue{true};
+	else if (_chunk == "false")
+		value = QCborValue{false};
+	else if (_chunk == "null")
+		value = QCborValue{nullptr};
+	else if (first != '-' && (first < '0' || first > '9'))
+		return false;
+	else {
+		auto ok = false;
+		if (!_chunk.contains('.') && !_chunk.contains('e') && !_chunk.contains('E')) {
+			const auto integer = _chunk.toLongLong(&ok);
+			if (ok)
+				value = QCborValue{integer};
+		}
+		if (!ok) {
+			const auto number = _chunk.toDouble(&ok);
+			if (!ok)
+				return false;
+			value = QCborValue{number};
+		}
+	}
+	return true;
+}
+
+#endif // QGENERICTREECBOR_H
@@ -0,0 +1,394 @@
+#ifndef QGENERICTREEINTRUSIVE_H
+#define QGENERICTREEINTRUSIVE_H
+
+#include "qgenerictreebase.h"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename T>
+class QGenericTreeIntrusiveWeakPointer;
+
+// A non atomic counterpart of QSharedPointer. The reference counts are placed directly in front of
+// the pointed to object, so a pointer is only a single word and copying it never touches another
+// cache line. Not thread safe, so all handles of one tree must be used from the same thread.
+// The block holds nothing else: T has to provide its allocator_type and an allocator() that returns the
+// allocator it was created with. Once T is destroyed, that allocator is kept in its place until the last
+// weak reference is gone as well, so it can free the block.
+template <typename T>
+class QGenericTreeIntrusivePointer
+{
+public:
+	QGenericTreeIntrusivePointer() = default;
+	QGenericTreeIntrusivePointer(std::nullptr_t);
+	QGenericTreeIntrusivePointer(const QGenericTreeIntrusivePointer &other);
+	QGenericTreeIntrusivePointer &operator=(const QGenericTreeIntrusivePointer &other);
+	QGenericTreeIntrusivePointer(QGenericTreeIntrusivePointer &&other) noexcept;
+	QGenericTreeIntrusivePointer &operator=(QGenericTreeIntrusivePointer &&other) noexcept;
+	~QGenericTreeIntrusivePointer();
+	friend inline void swap(QGenericTreeIntrusivePointer &lhs, QGenericTreeIntrusivePointer &rhs) noexcept { lhs.swap(rhs); } // must be implemented inline because of the friend declaration
+
+	explicit operator bool() const;
+	bool operator!() const;
+	friend inline bool operator==(const QGenericTreeIntrusivePointer &lhs, const QGenericTreeIntrusivePointer &rhs) { return lhs.d == rhs.d; } // must be implemented inline because of the friend declaration
+	friend inline bool operator!=(const QGenericTreeIntrusivePointer &lhs, const QGenericTreeIntrusivePointer &rhs) { return lhs.d != rhs.d; } // must be implemented inline because of the friend declaration
+	friend inline bool operator==(const QGenericTreeIntrusivePointer &lhs, const T *rhs) { return lhs.d == rhs; } // must be implemented inline because of the friend declaration
+	friend inline bool operator!=(const QGenericTreeIntrusivePointer &lhs, const T *rhs) { return lhs.d != rhs; } // must be implemented inline because of the friend declaration
+
+	T *data() const;
+	T &operator*() const;
+	T *operator->() const;
+	bool isNull() const;
+
+	void clear();
+	void swap(QGenericTreeIntrusivePointer &other) noexcept;
+	QGenericTreeIntrusiveWeakPointer<T> toWeakRef() const;
+
+	template <typename TAllocator, typename... TArgs>
+	static QGenericTreeIntrusivePointer create(const TAllocator &allocator, TArgs&&... args);
+	static QGenericTreeIntrusivePointer fromData(T *data);
+
+private:
+	friend class QGenericTreeIntrusiveWeakPointer<T>;
+
+	struct RefCount {
+		int strongRef;
+		int weakRef; // all strong refs together hold one weak ref
+	};
+
+	T *d = nullptr;
+
+	static constexpr std::size_t dataOffset();
+	static constexpr std::size_t blockSize();
+	static constexpr std::size_t blockAlignment();
+	static inline RefCount *refCount(T *data);
+	static inline void releaseWeak(T *data);
+};
+
+template <typename T>
+class QGenericTreeIntrusiveWeakPointer
+{
+public:
+	QGenericTreeIntrusiveWeakPointer() = default;
+	QGenericTreeIntrusiveWeakPointer(const QGenericTreeIntrusivePointer<T> &pointer);
+	QGenericTreeIntrusiveWeakPointer(const QGenericTreeIntrusiveWeakPointer &other);
+	QGenericTreeIntrusiveWeakPointer &operator=(const QGenericTreeIntrusiveWeakPointer &other);
+	QGenericTreeIntrusiveWeakPointer(QGenericTreeIntrusiveWeakPointer &&other) noexcept;
+	QGenericTreeIntrusiveWeakPointer &operator=(QGenericTreeIntrusiveWeakPointer &&other) noexcept;
+	~QGenericTreeIntrusiveWeakPointer();
+	friend inline void swap(QGenericTreeIntrusiveWeakPointer &lhs, QGenericTreeIntrusiveWeakPointer &rhs) noexcept { lhs.swap(rhs); } // must be implemented inline because of the friend declaration
+
+	explicit operator bool() const;
+	bool operator!() const;
+	bool isNull() const;
+
+	void clear();
+	void swap(QGenericTreeIntrusiveWeakPointer &other) noexcept;
+	QGenericTreeIntrusivePointer<T> toStrongRef() const;
+
+private:
+	T *d = nullptr;
+};
+
+// Pointer policy for QGenericTreeBase that uses the non atomic QGenericTreeIntrusivePointer and a raw
+// pointer to the parent node. The parent pointer is reset by the parent when it gets destroyed.
+class QGenericTreeIntrusivePointerPolicy
+{
+public:
+	template <typename T>
+	using Pointer = QGenericTreeIntrusivePointer<T>;
+	template <typename T>
+	using WeakPointer = QGenericTreeIntrusiveWeakPointer<T>;
+	template <typename T>
+	using ParentPointer = T*;
+
+	template <typename T, typename TAllocator, typename... TArgs>
+	static inline Pointer<T> create(const TAllocator &allocator, TArgs&&... args);
+	template <typename T>
+	static inline Pointer<T> toPointer(ParentPointer<T> parent);
+	template <typename T>
+	static inline ParentPointer<T> toParent(const Pointer<T> &pointer);
+};
+
+// GENERIC IMPLEMENTATION
+
+template <typename T>
+QGenericTreeIntrusivePointer<T>::QGenericTreeIntrusivePointer(std::nullptr_t) {}
+
+template <typename T>
+QGenericTreeIntrusivePointer<T>::QGenericTreeIntrusivePointer(const QGenericTreeIntrusivePointer &other) :
+	d{other.d}
+{
+	if (d)
+		++refCount(d)->strongRef;
+}
+
+template <typename T>
+QGenericTreeIntrusivePointer<T> &QGenericTreeIntrusivePointer<T>::operator=(const QGenericTreeIntrusivePointer &other)
+{
+	QGenericTreeIntrusivePointer copy{other};
+	swap(copy);
+	return *this;
+}
+
+template <typename T>
+QGenericTreeIntrusivePointer<T>::QGenericTreeIntrusivePointer(QGenericTreeIntrusivePointer &&other) noexcept :
+	d{other.d}
+{
+	other.d = nullptr;
+}
+
+template <typename T>
+QGenericTreeIntrusivePointer<T> &QGenericTreeIntrusivePointer<T>::operator=(QGenericTreeIntrusivePointer &&other) noexcept
+{
+	swap(other);
+	return *this;
+}
+
+template <typename T>
+QGenericTreeIntrusivePointer<T>::~QGenericTreeIntrusivePointer()
+{
+	clear();
+}
+
+template <typename T>
+QGenericTreeIntrusivePointer<T>::operator bool() const
+{
+	return d;
+}
+
+template <typename T>
+bool QGenericTreeIntrusivePointer<T>::operator!() const
+{
+	return !d;
+}
+
+template <typename T>
+T *QGenericTreeIntrusivePointer<T>::data() const
+{
+	return d;
+}
+
+template <typename T>
+T &QGenericTreeIntrusivePointer<T>::operator*() const
+{
+	return *d;
+}
+
+template <typename T>
+T *QGenericTreeIntrusivePointer<T>::operator->() const
+{
+	return d;
+}
+
+template <typename T>
+bool QGenericTreeIntrusivePointer<T>::isNull() const
+{
+	return !d;
+}
+
+template <typename T>
+void QGenericTreeIntrusivePointer<T>::clear()
+{
+	if (!d)
+		return;
+
+	const auto data = std::exchange(d, nullptr);
+	if (--refCount(data)->strongRef == 0) {
+		using TAllocator = typename T::allocator_type;
+		TAllocator allocator = data->allocator();
+		data->~T();
+		new (data) TAllocator{std::move(allocator)};
+		releaseWeak(data);
+	}
+}
+
+template <typename T>
+void QGenericTreeIntrusivePointer<T>::swap(QGenericTreeIntrusivePointer &other) noexcept
+{
+	std::swap(d, other.d);
+}
+
+template <typename T>
+QGenericTreeIntrusiveWeakPointer<T> QGenericTreeIntrusivePointer<T>::toWeakRef() const
+{
+	return QGenericTreeIntrusiveWeakPointer<T>{*this};
+}
+
+template <typename T>
+template <typename TAllocator, typename... TArgs>
+QGenericTreeIntrusivePointer<T> QGenericTreeIntrusivePointer<T>::create(const TAllocator &allocator, TArgs&&... args)
+{
+	static_assert(std::is_same_v<TAllocator, typename T::allocator_type>, "The data must be created with its own allocator type");
+	static_assert(sizeof(TAllocator) <= sizeof(T) && alignof(TAllocator) <= alignof(T), "The allocator must fit into the place of the data");
+
+	const auto block = static_cast<unsigned char*>(allocator.allocate(blockSize(), blockAlignment()));
+	new (block) RefCount{1, 1};
+
+	// the block must not leak if the constructor throws
+	QGenericTreeIntrusivePointer pointer;
+	QT_TRY {
+		pointer.d = new (block + dataOffset()) T{std::forward<TArgs>(args)...};
+	} QT_CATCH(...) {
+		allocator.deallocate(block, blockSize(), blockAlignment());
+		QT_RETHROW;
+	}
+	return pointer;
+}
+
+template <typename T>
+QGenericTreeIntrusivePointer<T> QGenericTreeIntrusivePointer<T>::fromData(T *data)
+{
+	QGenericTreeIntrusivePointer pointer;
+	pointer.d = data;
+	if (data)
+		++refCount(data)->strongRef;
+	return pointer;
+}
+
+template <typename T>
+constexpr std::size_t QGenericTreeIntrusivePointer<T>::dataOffset()
+{
+	// T is incomplete when the pointer class is instantiated, so this cannot be a static member
+	return (sizeof(RefCount) + alignof(T) - 1) / alignof(T) * alignof(T);
+}
+
+template <typename T>
+constexpr std::size_t QGenericTreeIntrusivePointer<T>::blockSize()
+{
+	return dataOffset() + sizeof(T);
+}
+
+template <typename T>
+constexpr std::size_t QGenericTreeIntrusivePointer<T>::blockAlignment()
+{
+	return qMax(alignof(RefCount), alignof(T));
+}
+
+template <typename T>
+inline typename QGenericTreeIntrusivePointer<T>::RefCount *QGenericTreeIntrusivePointer<T>::refCount(T *data)
+{
+	return reinterpret_cast<RefCount*>(reinterpret_cast<unsigned char*>(data) - dataOffset());
+}
+
+template <typename T>
+inline void QGenericTreeIntrusivePointer<T>::releaseWeak(T *data)
+{
+	// the data is gone by now, and its place holds the allocator
+	using TAllocator = typename T::allocator_type;
+	const auto count = refCount(data);
+	if (--count->weakRef == 0) {
+		const auto stored = std::launder(reinterpret_cast<TAllocator*>(data));
+		const TAllocator allocator = std::move(*stored);
+		stored->~TAllocator();
+		allocator.deallocate(count, blockSize(), blockAlignment());
+	}
+}
+
+
+template <typename T>
+QGenericTreeIntrusiveWeakPointer<T>::QGenericTreeIntrusiveWeakPointer(const QGenericTreeIntrusivePointer<T> &pointer) :
+	d{pointer.d}
+{
+	if (d)
+		++QGenericTreeIntrusivePointer<T>::refCount(d)->weakRef;
+}
+
+template <typename T>
+QGenericTreeIntrusiveWeakPointer<T>::QGenericTreeIntrusiveWeakPointer(const QGenericTreeIntrusiveWeakPointer &other) :
+	d{other.d}
+{
+	if (d)
+		++QGenericTreeIntrusivePointer<T>::refCount(d)->weakRef;
+}
+
+template <typename T>
+QGenericTreeIntrusiveWeakPointer<T> &QGenericTreeIntrusiveWeakPointer<T>::operator=(const QGenericTreeIntrusiveWeakPointer &other)
+{
+	QGenericTreeIntrusiveWeakPointer copy{other};
+	swap(copy);
+	return *this;
+}
+
+template <typename T>
+QGenericTreeIntrusiveWeakPointer<T>::QGenericTreeIntrusiveWeakPointer(QGenericTreeIntrusiveWeakPointer &&other) noexcept :
+	d{other.d}
+{
+	other.d = nullptr;
+}
+
+template <typename T>
+QGenericTreeIntrusiveWeakPointer<T> &QGenericTreeIntrusiveWeakPointer<T>::operator=(QGenericTreeIntrusiveWeakPointer &&other) noexcept
+{
+	swap(other);
+	return *this;
+}
+
+template <typename T>
+QGenericTreeIntrusiveWeakPointer<T>::~QGenericTreeIntrusiveWeakPointer()
+{
+	clear();
+}
+
+template <typename T>
+QGenericTreeIntrusiveWeakPointer<T>::operator bool() const
+{
+	return !isNull();
+}
+
+template <typename T>
+bool QGenericTreeIntrusiveWeakPointer<T>::operator!() const
+{
+	return isNull();
+}
+
+template <typename T>
+bool QGenericTreeIntrusiveWeakPointer<T>::isNull() const
+{
+	return !d || QGenericTreeIntrusivePointer<T>::refCount(d)->strongRef == 0;
+}
+
+template <typename T>
+void QGenericTreeIntrusiveWeakPointer<T>::clear()
+{
+	if (d)
+		QGenericTreeIntrusivePointer<T>::releaseWeak(std::exchange(d, nullptr));
+}
+
+template <typename T>
+void QGenericTreeIntrusiveWeakPointer<T>::swap(QGenericTreeIntrusiveWeakPointer &other) noexcept
+{
+	std::swap(d, other.d);
+}
+
+template <typename T>
+QGenericTreeIntrusivePointer<T> QGenericTreeIntrusiveWeakPointer<T>::toStrongRef() const
+{
+	return isNull() ?
+				QGenericTreeIntrusivePointer<T>{} :
+				QGenericTreeIntrusivePointer<T>::fromData(d);
+}
+
+
+
+template <typename T, typename TAllocator, typename... TArgs>
+inline QGenericTreeIntrusivePointerPolicy::Pointer<T> QGenericTreeIntrusivePointerPolicy::create(const TAllocator &allocator, TArgs&&... args)
+{
+	return Pointer<T>::create(allocator, std::forward<TArgs>(args)...);
+}
+
+template <typename T>
+inline QGenericTreeIntrusivePointerPolicy::Pointer<T> QGenericTreeIntrusivePointerPolicy::toPointer(ParentPointer<T> parent)
+{
+	return Pointer<T>::fromData(parent);
+}
+
+template <typename T>
+inline QGenericTreeIntrusivePointerPolicy::ParentPointer<T> QGenericTreeIntrusivePointerPolicy::toParent(const Pointer<T> &pointer)
+{
+	return pointer.data();
+}
+
+#endif // QGENERICTREEINTRUSIVE_H
@@ -5,7 +5,7 @@
 
 #include <QtCore/QMap>
 
-template <typename TKey, typename TValue>
-using QOrderedTree = QGenericTreeBase<TKey, TValue, QMap>;
+template <typename TKey, typename TValue, typename... TPolicies>
+using QOrderedTree = QGenericTreeBase<TKey, TValue, QMap, TPolicies...>;
 
 #endif // QORDEREDTREE_H
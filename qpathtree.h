@@ -0,0 +1,348 @@
+#ifndef QPATHTREE_H
+#define QPATHTREE_H
+
+#include "qgenerictreebase.h"
+#include "qflatmap.h"
+
+#include <algorithm>
+
+#include <QtCore/QString>
+#include <QtCore/QStringView>
+
+// A tree of QString keys that is addressed with single path strings like "a/b/c" instead of key lists.
+// Paths are split into views while descending, so lookups never build a list of keys or copy a segment.
+// Empty segments are skipped, which means "/a//b/" addresses the same node as "a/b". Only the keys of
+// newly created nodes are copied into QStrings. The child container must support lookups with
+// QStringView keys, like QFlatMap and QFlatHash do.
+template <typename TValue, template<class, class> class TContainer = QFlatMap, typename... TPolicies>
+class QPathTree
+{
+public:
+	using Tree = QGenericTreeBase<QString, TValue, TContainer, TPolicies...>;
+	using ConstNode = typename Tree::ConstNode;
+	using Node = typename Tree::Node;
+
+	static_assert(QGenericTreeIsLookupKey<TContainer<QString, TValue>, QString, QStringView>::value,
+				  "QPathTree requires a child container that supports lookups with QStringView keys");
+
+	// splits a path into its segments, one at a time
+	class segment_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = QStringView;
+		using difference_type = int;
+		using pointer = const QStringView*;
+		using reference = const QStringView&;
+
+		segment_iterator() = default;
+		segment_iterator(QStringView path, QChar separator);
+
+		bool operator==(const segment_iterator &other) const;
+		bool operator!=(const segment_iterator &other) const;
+		reference operator*() const;
+		pointer operator->() const;
+		segment_iterator &operator++();
+		segment_iterator operator++(int);
+
+	private:
+		QStringView _rest; // becomes null once the last segment was taken
+		QStringView _segment; // a null segment marks the end
+		QChar _separator;
+	};
+
+	// iterates over all nodes like the iterators of the tree, and additionally knows the separator to build paths
+	template <typename TIterValue>
+	class iterator_base : public Tree::template iterator_base<TIterValue>
+	{
+		friend class QPathTree;
+		using TreeIterator = typename Tree::template iterator_base<TIterValue>;
+
+	public:
+		iterator_base() = default;
+
+		iterator_base &operator++();
+		iterator_base operator++(int);
+		iterator_base &operator--();
+		iterator_base operator--(int);
+
+		QString path() const;
+
+	private:
+		QChar _separator;
+
+		iterator_base(TreeIterator it, QChar separator);
+	};
+
+	using iterator = iterator_base<TValue>;
+	using const_iterator = iterator_base<const TValue>;
+
+	explicit QPathTree(QChar separator = QLatin1Char('/'));
+
+	QChar separator() const;
+	const Tree &tree() const;
+	Tree &tree();
+	ConstNode rootNode() const;
+	Node rootNode();
+
+	bool contains(QStringView path) const;
+	int countElements(bool valueOnly = false) const;
+	ConstNode find(QStringView path) const;
+	Node find(QStringView path);
+	ConstNode operator[](QStringView path) const;
+	Node operator[](QStringView path);
+
+	segment_iterator segmentsBegin(QStringView path) const;
+	segment_iterator segmentsEnd() const;
+
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	void clear();
+
+private:
+	Tree _tree;
+	QChar _separator;
+};
+
+// GENERIC IMPLEMENTATION
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+QPathTree<TValue, TContainer, TPolicies...>::segment_iterator::segment_iterator(QStringView path, QChar separator) :
+	_rest{path},
+	_separator{separator}
+{
+	operator++();
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+bool QPathTree<TValue, TContainer, TPolicies...>::segment_iterator::operator==(const segment_iterator &other) const
+{
+	return _segment.data() == other._segment.data();
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+bool QPathTree<TValue, TContainer, TPolicies...>::segment_iterator::operator!=(const segment_iterator &other) const
+{
+	return _segment.data() != other._segment.data();
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::segment_iterator::reference QPathTree<TValue, TContainer, TPolicies...>::segment_iterator::operator*() const
+{
+	return _segment;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::segment_iterator::pointer QPathTree<TValue, TContainer, TPolicies...>::segment_iterator::operator->() const
+{
+	return &_segment;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::segment_iterator &QPathTree<TValue, TContainer, TPolicies...>::segment_iterator::operator++()
+{
+	while (!_rest.isNull()) {
+		const auto end = std::find(_rest.begin(), _rest.end(), _separator);
+		const auto length = static_cast<int>(end - _rest.begin());
+		_segment = _rest.left(length);
+		_rest = end != _rest.end() ? _rest.mid(length + 1) : QStringView{};
+		if (!_segment.isEmpty())
+			return *this;
+	}
+	_segment = QStringView{};
+	return *this;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::segment_iterator QPathTree<TValue, TContainer, TPolicies...>::segment_iterator::operator++(int)
+{
+	auto copy = *this;
+	operator++();
+	return copy;
+}
+
+
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+template <typename TIterValue>
+typename QPathTree<TValue, TContainer, TPolicies...>::template iterator_base<TIterValue> &QPathTree<TValue, TContainer, TPolicies...>::iterator_base<TIterValue>::operator++()
+{
+	TreeIterator::operator++();
+	return *this;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+template <typename TIterValue>
+typename QPathTree<TValue, TContainer, TPolicies...>::template iterator_base<TIterValue> QPathTree<TValue, TContainer, TPolicies...>::iterator_base<TIterValue>::operator++(int)
+{
+	auto copy = *this;
+	operator++();
+	return copy;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+template <typename TIterValue>
+typename QPathTree<TValue, TContainer, TPolicies...>::template iterator_base<TIterValue> &QPathTree<TValue, TContainer, TPolicies...>::iterator_base<TIterValue>::operator--()
+{
+	TreeIterator::operator--();
+	return *this;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+template <typename TIterValue>
+typename QPathTree<TValue, TContainer, TPolicies...>::template iterator_base<TIterValue> QPathTree<TValue, TContainer, TPolicies...>::iterator_base<TIterValue>::operator--(int)
+{
+	auto copy = *this;
+	operator--();
+	return copy;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+template <typename TIterValue>
+QString QPathTree<TValue, TContainer, TPolicies...>::iterator_base<TIterValue>::path() const
+{
+	// the keys are read straight from the iterator path, so no key list is built
+	auto size = std::max(0, static_cast<int>(this->_path.size()) - 1);
+	for (const auto &it : this->_path)
+		size += it.key().size();
+	QString path;
+	path.reserve(size);
+	for (auto i = 0; i < this->_path.size(); ++i) {
+		if (i > 0)
+			path.append(_separator);
+		path.append(this->_path[i].key());
+	}
+	return path;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+template <typename TIterValue>
+QPathTree<TValue, TContainer, TPolicies...>::iterator_base<TIterValue>::iterator_base(TreeIterator it, QChar separator) :
+	TreeIterator{std::move(it)},
+	_separator{separator}
+{}
+
+
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+QPathTree<TValue, TContainer, TPolicies...>::QPathTree(QChar separator) :
+	_separator{separator}
+{}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+QChar QPathTree<TValue, TContainer, TPolicies...>::separator() const
+{
+	return _separator;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+const typename QPathTree<TValue, TContainer, TPolicies...>::Tree &QPathTree<TValue, TContainer, TPolicies...>::tree() const
+{
+	return _tree;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::Tree &QPathTree<TValue, TContainer, TPolicies...>::tree()
+{
+	return _tree;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::ConstNode QPathTree<TValue, TContainer, TPolicies...>::rootNode() const
+{
+	return _tree.rootNode();
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::Node QPathTree<TValue, TContainer, TPolicies...>::rootNode()
+{
+	return _tree.rootNode();
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+bool QPathTree<TValue, TContainer, TPolicies...>::contains(QStringView path) const
+{
+	return _tree.contains(segmentsBegin(path), segmentsEnd());
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+int QPathTree<TValue, TContainer, TPolicies...>::countElements(bool valueOnly) const
+{
+	return _tree.countElements(valueOnly);
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::ConstNode QPathTree<TValue, TContainer, TPolicies...>::find(QStringView path) const
+{
+	return _tree.find(segmentsBegin(path), segmentsEnd());
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::Node QPathTree<TValue, TContainer, TPolicies...>::find(QStringView path)
+{
+	return _tree.find(segmentsBegin(path), segmentsEnd());
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::ConstNode QPathTree<TValue, TContainer, TPolicies...>::operator[](QStringView path) const
+{
+	return find(path);
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::Node QPathTree<TValue, TContainer, TPolicies...>::operator[](QStringView path)
+{
+	auto node = _tree.rootNode();
+	for (auto it = segmentsBegin(path), end = segmentsEnd(); it != end; ++it) {
+		auto child = node.child(*it);
+		node = child ? std::move(child) : node.emplaceChild(it->toString());
+	}
+	return node;
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::segment_iterator QPathTree<TValue, TContainer, TPolicies...>::segmentsBegin(QStringView path) const
+{
+	return segment_iterator{path, _separator};
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::segment_iterator QPathTree<TValue, TContainer, TPolicies...>::segmentsEnd() const
+{
+	return segment_iterator{};
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::iterator QPathTree<TValue, TContainer, TPolicies...>::begin()
+{
+	return iterator{_tree.begin(), _separator};
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::iterator QPathTree<TValue, TContainer, TPolicies...>::end()
+{
+	return iterator{_tree.end(), _separator};
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::const_iterator QPathTree<TValue, TContainer, TPolicies...>::begin() const
+{
+	return const_iterator{_tree.begin(), _separator};
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+typename QPathTree<TValue, TContainer, TPolicies...>::const_iterator QPathTree<TValue, TContainer, TPolicies...>::end() const
+{
+	return const_iterator{_tree.end(), _separator};
+}
+
+template <typename TValue, template<class, class> class TContainer, typename... TPolicies>
+void QPathTree<TValue, TContainer, TPolicies...>::clear()
+{
+	_tree.clear();
+}
+
+#endif // QPATHTREE_H
@@ -0,0 +1,577 @@
+#ifndef QSMALLCHILDMAP_H
+#define QSMALLCHILDMAP_H
+
+#include "qgenerictreebase.h"
+
+#include <algorithm>
+#include <new>
+
+#include <QtCore/QMap>
+#include <QtCore/QHash>
+
+// A child container for QGenericTreeBase that stores up to TInlineSize entries directly inside of the
+// node and only spills them into a TSpillContainer once more children are added. Empty and small nodes
+// thus never allocate memory for their children. If the spill container is a QMap, the inline entries
+// are kept sorted, so the iteration order is the same as for a QMap.
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+class QSmallChildMap
+{
+	static_assert(TInlineSize > 0, "TInlineSize must be at least 1");
+
+	using SpillContainer = TSpillContainer<TKey, TValue>;
+	static constexpr bool Ordered = std::is_same_v<SpillContainer, QMap<TKey, TValue>>;
+
+	struct Entry {
+		TKey key;
+		TValue value;
+	};
+
+public:
+	template <bool TConst>
+	class iterator_base
+	{
+		friend class QSmallChildMap;
+		template <bool TOtherConst>
+		friend class iterator_base;
+
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = TValue;
+		using difference_type = qptrdiff;
+		using pointer = std::conditional_t<TConst, const TValue*, TValue*>;
+		using reference = std::conditional_t<TConst, const TValue&, TValue&>;
+
+		iterator_base() = default;
+		template <bool TOtherConst, typename = std::enable_if_t<TConst && !TOtherConst>>
+		iterator_base(const iterator_base<TOtherConst> &other);
+
+		bool operator==(const iterator_base &other) const;
+		bool operator!=(const iterator_base &other) const;
+		reference operator*() const;
+		pointer operator->() const;
+		iterator_base &operator++();
+		iterator_base operator++(int);
+		iterator_base &operator--();
+		iterator_base operator--(int);
+
+		const TKey &key() const;
+		reference value() const;
+
+	private:
+		using SpillIterator = std::conditional_t<TConst, typename SpillContainer::const_iterator, typename SpillContainer::iterator>;
+
+		// if the map has spilled, _entry is null and _spill is used instead
+		Entry *_entry = nullptr;
+		SpillIterator _spill;
+
+		iterator_base(Entry *entry);
+		iterator_base(SpillIterator spill);
+	};
+
+	using iterator = iterator_base<false>;
+	using const_iterator = iterator_base<true>;
+	using key_type = TKey;
+	using mapped_type = TValue;
+	using size_type = int;
+
+	QSmallChildMap() = default;
+	QSmallChildMap(const QSmallChildMap &other);
+	QSmallChildMap &operator=(const QSmallChildMap &other);
+	QSmallChildMap(QSmallChildMap &&other) noexcept;
+	QSmallChildMap &operator=(QSmallChildMap &&other) noexcept;
+	~QSmallChildMap();
+
+	int size() const;
+	int count() const;
+	bool empty() const;
+	bool isEmpty() const;
+	bool isSpilled() const;
+
+	bool contains(const TKey &key) const;
+	TValue value(const TKey &key, const TValue &defaultValue = TValue{}) const;
+	TValue &first();
+	const TValue &first() const;
+	TValue &last();
+	const TValue &last() const;
+
+	iterator find(const TKey &key);
+	const_iterator find(const TKey &key) const;
+	const_iterator constFind(const TKey &key) const;
+	iterator insert(const TKey &key, const TValue &value);
+	TValue take(const TKey &key);
+	int remove(const TKey &key);
+	iterator erase(iterator it);
+	void clear();
+
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+	const_iterator cbegin() const;
+	const_iterator cend() const;
+	const_iterator constBegin() const;
+	const_iterator constEnd() const;
+
+private:
+	alignas(Entry) unsigned char _storage[TInlineSize * sizeof(Entry)];
+	int _size = 0;
+	bool _spilled = false;
+	SpillContainer _spill;
+
+	inline Entry *entries() const;
+	Entry *findEntry(const TKey &key) const;
+	Entry *insertEntry(const TKey &key, const TValue &value);
+	void eraseEntry(Entry *entry);
+	void spill();
+	void destroyEntries();
+};
+
+template <typename TKey, typename TValue>
+using QSmallMap = QSmallChildMap<TKey, TValue, 4, QMap>;
+
+template <typename TKey, typename TValue>
+using QSmallHash = QSmallChildMap<TKey, TValue, 4, QHash>;
+
+template <typename TKey, typename TValue, typename... TPolicies>
+using QSmallOrderedTree = QGenericTreeBase<TKey, TValue, QSmallMap, TPolicies...>;
+
+template <typename TKey, typename TValue, typename... TPolicies>
+using QSmallUnorderedTree = QGenericTreeBase<TKey, TValue, QSmallHash, TPolicies...>;
+
+// GENERIC IMPLEMENTATION
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+template <bool TOtherConst, typename>
+QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::iterator_base(const iterator_base<TOtherConst> &other) :
+	_entry{other._entry},
+	_spill{other._spill}
+{}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+bool QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::operator==(const iterator_base &other) const
+{
+	return _entry ? _entry == other._entry : _spill == other._spill;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+bool QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::operator!=(const iterator_base &other) const
+{
+	return !operator==(other);
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::template iterator_base<TConst>::reference QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::operator*() const
+{
+	return _entry ? _entry->value : *_spill;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::template iterator_base<TConst>::pointer QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::operator->() const
+{
+	return &operator*();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::template iterator_base<TConst> &QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::operator++()
+{
+	if (_entry)
+		++_entry;
+	else
+		++_spill;
+	return *this;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::template iterator_base<TConst> QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::operator++(int)
+{
+	auto copy = *this;
+	operator++();
+	return copy;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::template iterator_base<TConst> &QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::operator--()
+{
+	if (_entry)
+		--_entry;
+	else
+		--_spill;
+	return *this;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::template iterator_base<TConst> QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::operator--(int)
+{
+	auto copy = *this;
+	operator--();
+	return copy;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+const TKey &QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::key() const
+{
+	return _entry ? _entry->key : _spill.key();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::template iterator_base<TConst>::reference QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::value() const
+{
+	return operator*();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::iterator_base(Entry *entry) :
+	_entry{entry}
+{}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+template <bool TConst>
+QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator_base<TConst>::iterator_base(SpillIterator spill) :
+	_spill{std::move(spill)}
+{}
+
+
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::QSmallChildMap(const QSmallChildMap &other) :
+	_size{other._size},
+	_spilled{other._spilled},
+	_spill{other._spill}
+{
+	if (!_spilled)
+		std::uninitialized_copy(other.entries(), other.entries() + _size, entries());
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer> &QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::operator=(const QSmallChildMap &other)
+{
+	if (this != &other) {
+		destroyEntries();
+		if (!other._spilled)
+			std::uninitialized_copy(other.entries(), other.entries() + other._size, entries());
+		_size = other._size;
+		_spilled = other._spilled;
+		_spill = other._spill;
+	}
+	return *this;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::QSmallChildMap(QSmallChildMap &&other) noexcept :
+	_size{other._size},
+	_spilled{other._spilled},
+	_spill{std::move(other._spill)}
+{
+	if (!_spilled)
+		std::uninitialized_move(other.entries(), other.entries() + _size, entries());
+	other.clear();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer> &QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::operator=(QSmallChildMap &&other) noexcept
+{
+	if (this != &other) {
+		destroyEntries();
+		if (!other._spilled)
+			std::uninitialized_move(other.entries(), other.entries() + other._size, entries());
+		_size = other._size;
+		_spilled = other._spilled;
+		_spill = std::move(other._spill);
+		other.clear();
+	}
+	return *this;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::~QSmallChildMap()
+{
+	destroyEntries();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+int QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::size() const
+{
+	return _spilled ? _spill.size() : _size;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+int QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::count() const
+{
+	return size();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+bool QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::empty() const
+{
+	return size() == 0;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+bool QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::isEmpty() const
+{
+	return size() == 0;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+bool QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::isSpilled() const
+{
+	return _spilled;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+bool QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::contains(const TKey &key) const
+{
+	return _spilled ? _spill.contains(key) : findEntry(key) != nullptr;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+TValue QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::value(const TKey &key, const TValue &defaultValue) const
+{
+	if (_spilled)
+		return _spill.value(key, defaultValue);
+	const auto entry = findEntry(key);
+	return entry ? entry->value : defaultValue;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+TValue &QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::first()
+{
+	return *begin();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+const TValue &QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::first() const
+{
+	return *begin();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+TValue &QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::last()
+{
+	return *--end();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+const TValue &QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::last() const
+{
+	return *--end();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::find(const TKey &key)
+{
+	if (_spilled)
+		return _spill.find(key);
+	const auto entry = findEntry(key);
+	return entry ? iterator{entry} : end();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::const_iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::find(const TKey &key) const
+{
+	if (_spilled)
+		return _spill.constFind(key);
+	const auto entry = findEntry(key);
+	return entry ? const_iterator{entry} : cend();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::const_iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::constFind(const TKey &key) const
+{
+	return find(key);
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::insert(const TKey &key, const TValue &value)
+{
+	if (!_spilled) {
+		if (const auto entry = findEntry(key); entry) {
+			entry->value = value;
+			return iterator{entry};
+		} else if (_size < TInlineSize)
+			return iterator{insertEntry(key, value)};
+		else
+			spill();
+	}
+	return _spill.insert(key, value);
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+TValue QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::take(const TKey &key)
+{
+	if (_spilled)
+		return _spill.take(key);
+
+	const auto entry = findEntry(key);
+	if (!entry)
+		return TValue{};
+	auto value = std::move(entry->value);
+	eraseEntry(entry);
+	return value;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+int QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::remove(const TKey &key)
+{
+	if (_spilled)
+		return _spill.remove(key);
+
+	const auto entry = findEntry(key);
+	if (!entry)
+		return 0;
+	eraseEntry(entry);
+	return 1;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::erase(iterator it)
+{
+	if (_spilled)
+		return _spill.erase(it._spill);
+
+	// the entry that took the place of the erased one is the next one to be visited
+	const auto index = it._entry - entries();
+	eraseEntry(it._entry);
+	return iterator{entries() + index};
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+void QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::clear()
+{
+	destroyEntries();
+	_size = 0;
+	_spilled = false;
+	_spill.clear();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::begin()
+{
+	return _spilled ? iterator{_spill.begin()} : iterator{entries()};
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::end()
+{
+	return _spilled ? iterator{_spill.end()} : iterator{entries() + _size};
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::const_iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::begin() const
+{
+	return cbegin();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::const_iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::end() const
+{
+	return cend();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::const_iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::cbegin() const
+{
+	return _spilled ? const_iterator{_spill.cbegin()} : const_iterator{entries()};
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::const_iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::cend() const
+{
+	return _spilled ? const_iterator{_spill.cend()} : const_iterator{entries() + _size};
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::const_iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::constBegin() const
+{
+	return cbegin();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::const_iterator QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::constEnd() const
+{
+	return cend();
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+inline typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::Entry *QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::entries() const
+{
+	return std::launder(reinterpret_cast<Entry*>(const_cast<unsigned char*>(_storage)));
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::Entry *QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::findEntry(const TKey &key) const
+{
+	const auto begin = entries();
+	const auto end = begin + _size;
+	if constexpr (Ordered) {
+		const auto entry = std::lower_bound(begin, end, key, [](const Entry &lhs, const TKey &rhs) {
+			return lhs.key < rhs;
+		});
+		return entry != end && !(key < entry->key) ? entry : nullptr;
+	} else {
+		const auto entry = std::find_if(begin, end, [&](const Entry &other) {
+			return other.key == key;
+		});
+		return entry != end ? entry : nullptr;
+	}
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+typename QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::Entry *QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::insertEntry(const TKey &key, const TValue &value)
+{
+	const auto begin = entries();
+	auto entry = begin + _size;
+	if constexpr (Ordered) {
+		// shift all larger entries one step back to keep the entries sorted
+		for (; entry != begin && key < (entry - 1)->key; --entry) {
+			new (entry) Entry{std::move(*(entry - 1))};
+			(entry - 1)->~Entry();
+		}
+	}
+	new (entry) Entry{key, value};
+	++_size;
+	return entry;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+void QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::eraseEntry(Entry *entry)
+{
+	const auto last = entries() + _size - 1;
+	if constexpr (Ordered)
+		std::move(entry + 1, last + 1, entry);
+	else if (entry != last)
+		*entry = std::move(*last);
+	last->~Entry();
+	--_size;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+void QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::spill()
+{
+	for (auto entry = entries(), end = entry + _size; entry != end; ++entry)
+		_spill.insert(std::move(entry->key), std::move(entry->value));
+	destroyEntries();
+	_size = 0;
+	_spilled = true;
+}
+
+template <typename TKey, typename TValue, int TInlineSize, template<class, class> class TSpillContainer>
+void QSmallChildMap<TKey, TValue, TInlineSize, TSpillContainer>::destroyEntries()
+{
+	if (!_spilled)
+		std::destroy(entries(), entries() + _size);
+}
+
+#endif // QSMALLCHILDMAP_H
@@ -5,7 +5,7 @@
 
 #include <QtCore/QHash>
 
-template <typename TKey, typename TValue>
-using QUnorderedTree = QGenericTreeBase<TKey, TValue, QHash>;
+template <typename TKey, typename TValue, typename... TPolicies>
+using QUnorderedTree = QGenericTreeBase<TKey, TValue, QHash, TPolicies...>;
 
 #endif // QUNORDEREDTREE_H